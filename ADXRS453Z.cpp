@@ -4,9 +4,11 @@
  */
 
 #include <ADXRS453Z.h>
+#include <RobotParams.h>
+#include <ThreadConfig.h>
 #include <cstdarg>
 
-ADXRS453Z::ADXRS453Z() {
+ADXRS453Z::ADXRS453Z(bool bStartTask) {
 	spi = new SPI(SPI::kOnboardCS3);
 	spi->SetClockRate(4000000); //4 MHz (rRIO max, gyro can go high)
 	spi->SetClockActiveHigh();
@@ -32,7 +34,7 @@ ADXRS453Z::ADXRS453Z() {
 	calibration_timer = new Timer();
 	calibration_timer->Start();
 
-	pTask = new Task("tADSRX543Z", &ADXRS453Z::StartTask, this);
+	pTask = bStartTask ? new Task(GYRO_TASKNAME, &ADXRS453Z::StartTask, this) : NULL;
 }
 ADXRS453Z::~ADXRS453Z() {
 
@@ -40,6 +42,7 @@ ADXRS453Z::~ADXRS453Z() {
 
 void ADXRS453Z::StartTask(ADXRS453Z *pThis)
 {
+	ThreadConfig::Apply(GYRO_TASKNAME, GYRO_PRIORITY);
 
 	while (true)
 	{
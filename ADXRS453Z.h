@@ -14,7 +14,7 @@ int ADXRS453ZUpdateFunction(int pointer_val);
 
 class ADXRS453Z : public PIDSource{
 	public:
-		ADXRS453Z();
+		ADXRS453Z(bool bStartTask = true);		// false leaves calling Update() to the caller
 		virtual ~ADXRS453Z();
 		static void StartTask(ADXRS453Z *pThis);
 		float GetRate();
@@ -23,10 +23,10 @@ class ADXRS453Z : public PIDSource{
 		void Reset();
 		void Zero(); //added by Taylor Smith
 		void Update();
+		void UpdateData();		// integrate the last sample, Update() calls it once calibrated
 		float Offset();
 		double PIDGet();
 	private:
-		void UpdateData();
 		void Calibrate();
 		static void check_parity(unsigned char * command); //gyro requires odd parity for command
 		static int bits(unsigned char val); //returns number of on bits in a byte (helper for parity check)
@@ -11,7 +11,7 @@
 
 
 Arm* Arm::pInstance;
-Arm::Arm() : ComponentBase(ARM_TASKNAME, ARM_QUEUE, ARM_PRIORITY){
+Arm::Arm() : ComponentBase(ARM_TASKNAME, ARM_QUEUE, ARM_PRIORITY, ARM_TICK_PERIOD){
 	pShootTimer = new Timer();
 
 	pLED = new Relay(1,Relay::kBothDirections);
@@ -92,7 +92,7 @@ void Arm::Run(){
 		if(!bIntakePressedLastFrame){
 			bIsIntaking = !bIsIntaking;
 			bIntakePressedLastFrame = true;
-			Intake(localMessage.params.armParams.direction);
+			Intake(GetParams<COMMAND_ARM_INTAKE>(localMessage).direction);
 		}
 		break;
 
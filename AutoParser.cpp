@@ -1,452 +1,475 @@
 /** \file
  *  Autonomous script parser
+ *
+ * Turns script text into AutoInstructions and checks them.  Nothing here
+ * needs WPILib, so tools/ScriptCheck.cpp builds it on any host.
  */
 
-#include <Autonomous.h>
-#include <AutoParser.h>
-#include <ComponentBase.h>
-#include <RobotParams.h>
-#include <string.h>
+#include <math.h>
+#include <stdarg.h>
 #include <stdlib.h>
-
-#include <iostream>
-#include <fstream>
-#include <string>
-
-#include <WPILib.h>
+#include <string.h>
 
 //Robot
-
-using namespace std;
+#include <AutoParser.h>
+#include <RobotParams.h>
 
 const char *szTokens[] = {
-		"START",
-		"FINISH",
-		"MODE",
-		"DEBUG",
-		"MESSAGE",
-		"BEGIN",
-		"END",
-		"DELAY",			//!<(seconds)
-		"MOVE",				//!<(left speed) (right speed)
-		"MMOVE",			//!<(speed) (distance:inches) (timeout)
-		"MLINE",			//!<(speed) (distance:inches) (timeout)
-		"TURN",				//!<(degrees) (timeout)
-		"STRAIGHT",			//!<(speed) (duration)
-		"SEARCH",
-		"AIM",
-		"INTAKE",
-		"STOPINTAKE",
-		"RIDE",
-		"LOWEST",
-		"AFTERSHOOT",
-		"THROWUP",
-		"SHOOT",
-		"SETANGLE",
-		"LOWER",
-		"RAISE",
-		"TAILDOWN",
-		"TAILUP",
-		"REDSENSE",
-		//DRIVETRAIN
-		"STARTDRIVEFWD",	//!<(drive speed)
-		"STARTDRIVEBCK",	//!<(drive speed)
-		"STOPDRIVE",
-		"SHORT",
-		"JAWOPEN",
-		"JAWCLOSE",
+#define AUTO_TOKEN_KEYWORD(name, keyword, params, wait) keyword,
+		AUTO_TOKEN_TABLE(AUTO_TOKEN_KEYWORD)
+#undef AUTO_TOKEN_KEYWORD
 		"NOP" };
-//TODO: add START and FINISH, which send messages to all components
+
+const char *szTokenParams[] = {
+#define AUTO_TOKEN_PARAMS(name, keyword, params, wait) params,
+		AUTO_TOKEN_TABLE(AUTO_TOKEN_PARAMS)
+#undef AUTO_TOKEN_PARAMS
+		"" };
+
+const AUTO_WAIT tokenWaits[] = {
+#define AUTO_TOKEN_WAIT(name, keyword, params, wait) AUTO_WAIT_##wait,
+		AUTO_TOKEN_TABLE(AUTO_TOKEN_WAIT)
+#undef AUTO_TOKEN_WAIT
+		AUTO_WAIT_NONE };
+//TODO: START and FINISH should send messages to all components
 // (Begin and End are doing this now, but they shouldn't)
 
-bool Autonomous::Evaluate(std::string rStatement) {
-	char *pToken;
-	char *pCurrLinePos;
-	int iCommand;
-	float fParam1;
-	bool bReturn = false; ///setting this to true WILL cause auto parsing to quit!
-	string rStatus;
-
-	if(rStatement.empty()) {
-		printf("statement is empty");
-		return (bReturn);
-	}
+AUTO_COMMAND_TOKENS AutoFindToken(const char *szKeyword, size_t uLength)
+{
+	AUTO_COMMAND_TOKENS token;
 
-	// process the autonomous motion
+	// one case per keyword, two keywords with the same hash would not compile
 
-	pCurrLinePos = (char *) rStatement.c_str();
+	switch(AutoKeywordHash(szKeyword, uLength))
+	{
+#define AUTO_TOKEN_CASE(name, keyword, params, wait) \
+	case AutoKeywordHash(keyword, sizeof(keyword) - 1): \
+		token = AUTO_TOKEN_##name; \
+		break;
 
-	if(*pCurrLinePos == sComment) {
-		return (bReturn);
-	}
+	AUTO_TOKEN_TABLE(AUTO_TOKEN_CASE)
 
-	// find first token
+#undef AUTO_TOKEN_CASE
+	default:
+		return(AUTO_TOKEN_LAST);
+	}
 
-	pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
+	// any other word could still land on a keyword's hash
 
-	if(pToken == NULL)
+	if((strlen(szTokens[token]) != uLength) || strncmp(szKeyword, szTokens[token], uLength))
 	{
-		SmartDashboard::PutString("Auto Status","DEATH BY PARAMS!");
-		PRINTAUTOERROR;
-		rStatus.append("missing token");
-		printf("%0.3lf %s\n", pDebugTimer->Get(), rStatement.c_str());
-		return (true);
+		return(AUTO_TOKEN_LAST);
 	}
 
-	// which command are we to execute??
-	// this can be (easily) be made much faster... any student want to improve on this?
+	return(token);
+}
 
-	for(iCommand = AUTO_TOKEN_MODE; iCommand < AUTO_TOKEN_LAST; iCommand++) {
-		//printf("comparing %s to %s\n", pToken, szTokens[iCommand]);
-		if(!strncmp(pToken, szTokens[iCommand], strlen(szTokens[iCommand]))) {
-			break;
-		}
+bool AutoParallelAllowed(AUTO_COMMAND_TOKENS token)
+{
+	if(token == AUTO_TOKEN_BEGIN)
+	{
+		return(false);				// tells the components right away
 	}
 
-	if(iCommand == AUTO_TOKEN_LAST) {
-		// no valid token found
-		rStatus.append("no tokens - check script spelling");
-		printf("%0.3lf %s\n", pDebugTimer->Get(), rStatement.c_str());
-		return (true);
+	switch(tokenWaits[token])
+	{
+	case AUTO_WAIT_DELAY:
+	case AUTO_WAIT_SHOOT:
+	case AUTO_WAIT_SEQUENCE:
+		return(false);
+
+	default:
+		return(true);
 	}
+}
 
-	// if we are paused wait here before executing a real command
+bool AutoCompileLine(const char *szLine, int iLine, AutoInstruction &instruction)
+{
+	const char *pKeyword;
+	const char *pCursor;
 
-	while(bPauseAutoMode)
-	{
-		Wait(0.02);
-	}
+	// a line of nothing but delimiters, like a CRLF blank line, has no keyword
+	// at all and would end the script if it were compiled
 
-	// execute the proper command
+	pKeyword = szLine + strspn(szLine, szDelimiters);
 
-	if(iAutoDebugMode)
+	if((*pKeyword == '\0') || (*pKeyword == sComment))
 	{
-		printf("%0.3lf %s %s\n", pDebugTimer->Get(), pToken, pCurrLinePos);
+		return(false);
 	}
 
-	switch (iCommand)
-	{
+	instruction.iLine = iLine;
+	instruction.iParams = 0;
+	instruction.szLine = szLine;
 
-	case AUTO_TOKEN_START_AUTO:
-		Start();
-		rStatus.append("starting auto");
-		break;
+	// which command is it?
 
-	case AUTO_TOKEN_FINISH_AUTO:
-		Finish();
-		rStatus.append("finishing auto");
-		break;
+	pCursor = pKeyword + strcspn(pKeyword, szDelimiters);
+	instruction.token = AutoFindToken(pKeyword, pCursor - pKeyword);
 
-	case AUTO_TOKEN_BEGIN:
-		Begin(pCurrLinePos);
-		rStatus.append("begin");
-		break;
+	// everything after the keyword, then as many numbers as there are
 
-	case AUTO_TOKEN_END:
-		End(pCurrLinePos);
-		rStatus.append("done");
-		bReturn = true;
-		break;
+	pCursor += strspn(pCursor, szDelimiters);
+	instruction.szText = pCursor;
 
-	case AUTO_TOKEN_DEBUG:
-		pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
-		iAutoDebugMode = atoi(pToken);
-		break;
+	while((*pCursor != '\0') && (instruction.iParams < AUTO_MAX_PARAMS))
+	{
+		instruction.fParams[instruction.iParams++] = atof(pCursor);
+		pCursor += strcspn(pCursor, szDelimiters);
+		pCursor += strspn(pCursor, szDelimiters);
+	}
 
-	case AUTO_TOKEN_MESSAGE:
-		printf("%0.3lf %03d: %s\n", pDebugTimer->Get(), lineNumber, pCurrLinePos);
-		break;
+	return(true);
+}
 
-	case AUTO_TOKEN_DELAY:
-		pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
+int AutoCompileText(char *szText, AutoInstruction *program)
+{
+	char *pLine = szText;
+	char *pEnd;
+	int iLength = 0;
 
-		if (pToken == NULL)
-		{
-			rStatus.append("missing parameter");
-		}
-		else
-		{
-			fParam1 = atof(pToken);
-			rStatus.append("wait");
+	// each line is cut off where it ends, the instructions point into the text
 
-			Delay(fParam1);
-		}
-		break;
+	for(int i = 0; pLine != NULL; ++i)
+	{
+		pEnd = strchr(pLine, '\n');
 
-	case AUTO_TOKEN_MOVE:
-		if (!Move(pCurrLinePos))
+		if(pEnd)
 		{
-			rStatus.append("move error");
+			*pEnd = '\0';
 		}
-		else
-		{
-			rStatus.append("move");
-		}
-		break;
 
-	case AUTO_TOKEN_MMOVE:
-		if (!MeasuredMove(pCurrLinePos))
+		if(AutoCompileLine(pLine, i, program[iLength]))
 		{
-			rStatus.append("move error");
+			iLength++;
 		}
-		else
-		{
-			rStatus.append("move");
-		}
-		break;
 
-	case AUTO_TOKEN_MLINE:
-		if (!MeasuredMoveToLine(pCurrLinePos))
-		{
-			rStatus.append("move line error");
-		}
-		else
-		{
-			rStatus.append("move line");
-		}
-		break;
+		pLine = pEnd ? (pEnd + 1) : NULL;
+	}
 
-	case AUTO_TOKEN_TURN:
-		if (!Turn(pCurrLinePos))
-		{
-			rStatus.append("turn error");
-		}
-		else
-		{
-			rStatus.append("turn");
-		}
-		break;
+	return(iLength);
+}
 
-	case AUTO_TOKEN_STRAIGHT:
-		if (!Straight(pCurrLinePos))
-		{
-			rStatus.append("straight error");
-		}
-		else
-		{
-			rStatus.append("straight");
-		}
-		break;
-	case AUTO_TOKEN_SEARCH:
-		printf("search token\n");
-		if (!Search())
-		{
-			rStatus.append("search error");
-		}
-		else
-		{
-			rStatus.append("search");
-		}
-		break;
-	case AUTO_TOKEN_AIM:
-		if (!Aim())
-		{
-			rStatus.append("aim error");
-		}
-		else
-		{
-			rStatus.append("aiming");
-		}
-		break;
+///prints one problem the way a compiler would, and counts it
+static void Problem(AutoCheck &check, FILE *pReport, const char *szName, int iLine,
+		const char *szLevel, const char *szFormat, ...)
+{
+	va_list args;
 
-	case AUTO_TOKEN_INTAKE:
-		if(!Intake())
-		{
-			rStatus.append("intake error");
-		}
-		else
-		{
-			rStatus.append("intaking");
-		}
-		break;
+	if(!strcmp(szLevel, "error"))
+	{
+		check.iErrors++;
+	}
+	else if(!strcmp(szLevel, "warning"))
+	{
+		check.iWarnings++;
+	}
 
-	case AUTO_TOKEN_INTAKESTOP:
-		Message.command = COMMAND_ARM_INTAKE_STOP;
-		CommandNoResponse(ARM_QUEUE);
-		break;
+	if(pReport == NULL)
+	{
+		return;
+	}
 
-	case AUTO_TOKEN_RIDE:
-		if(!Ride())
-		{
-			rStatus.append("ride error");
-		}
-		else
-		{
-			rStatus.append("ride");
-		}
-		break;
-	case AUTO_TOKEN_AFTERSHOOT:
-		Message.command = COMMAND_ARM_MOVE_AFTERSHOOT;
-		CommandNoResponse(ARM_QUEUE);
-		break;
-	case AUTO_TOKEN_LOWERINTAKE:
-		Message.command = COMMAND_AUTONOMOUS_MOVEINTAKE;
-		CommandNoResponse(ARM_QUEUE);
-		break;
+	// editors count lines from 1
 
-	case AUTO_TOKEN_THROWUP:
-		if(!Throwup())
-		{
-			rStatus.append("throwup error");
-		}
-		else
-		{
-			rStatus.append("throwing up");
-		}
-		break;
+	fprintf(pReport, "%s:%d: %s: ", szName, iLine + 1, szLevel);
+	va_start(args, szFormat);
+	vfprintf(pReport, szFormat, args);
+	va_end(args);
+	fputc('\n', pReport);
+}
 
-	case AUTO_TOKEN_SHOOT:
-		printf("shooting\n");
-		if(!Shoot())
-		{
-			rStatus.append("shoot error");
-		}
-		else
-		{
-			rStatus.append("shooting");
-		}
-		break;
-	case AUTO_TOKEN_SETANGLE:
-		if(!SetAngle())
-		{
-			rStatus.append("angle set error");
-		}
-		else
-		{
-			rStatus.append("setting angle");
-		}
-		break;
+///checks the numbers after the keyword as they were written, atof() makes 0 of anything
+static void CheckParams(const AutoInstruction &instruction, AutoCheck &check, FILE *pReport, const char *szName)
+{
+	const char *szKeyword = szTokens[instruction.token];
+	const char *pKind = szTokenParams[instruction.token];
+	const char *pCursor = instruction.szText;
+	char *pEnd;
+	int iRequired = strcspn(pKind, "|");
+	int iGiven = 0;
+	double fValue;
+
+	if(*pKind == '*')
+	{
+		return;
+	}
 
-	case AUTO_TOKEN_LOWER:
-		if(!Lower())
-		{
-			rStatus.append("lower error");
-		}
-		else
-		{
-			rStatus.append("lowering");
-		}
-		break;
-	case AUTO_TOKEN_RAISE:
-		if(!Raise())
-		{
-			rStatus.append("lower error");
-		}
-		else
+	for(; *pKind != '\0'; ++pKind)
+	{
+		if(*pKind == '|')
 		{
-			rStatus.append("lowering");
+			continue;
 		}
-		break;
 
-	case AUTO_TOKEN_TAILDOWN:
-		if(!TailDown())
+		if(*pCursor == '\0')
 		{
-			rStatus.append("tail down error");
+			if(iGiven < iRequired)
+			{
+				Problem(check, pReport, szName, instruction.iLine, "error", "%s needs %d number%s, it has %d",
+						szKeyword, iRequired, (iRequired == 1) ? "" : "s", iGiven);
+			}
+
+			return;
 		}
-		else
+
+		fValue = strtod(pCursor, &pEnd);
+
+		if((pEnd == pCursor) || !strchr(szDelimiters, *pEnd))
 		{
-			rStatus.append("lowering tail");
+			Problem(check, pReport, szName, instruction.iLine, "error", "%s: '%.*s' is not a number",
+					szKeyword, (int)strcspn(pCursor, szDelimiters), pCursor);
+			return;
 		}
-		break;
 
-	case AUTO_TOKEN_TAILUP:
-		if(!TailUp())
+		switch(*pKind)
 		{
-			rStatus.append("raise tail error");
+		case 'v':
+			if(fabs(fValue) > MAX_VELOCITY_PARAM)
+			{
+				Problem(check, pReport, szName, instruction.iLine, "error",
+						"%s: speed %g is more than MAX_VELOCITY_PARAM (%g)", szKeyword, fValue, MAX_VELOCITY_PARAM);
+			}
+			break;
+
+		case 'a':
+			if(fabs(fValue) > 360.0)
+			{
+				Problem(check, pReport, szName, instruction.iLine, "error",
+						"%s: angle %g is more than a whole turn", szKeyword, fValue);
+			}
+			break;
+
+		case 's':
+		case 't':
+		case 'r':
+			if(fValue <= 0.0)
+			{
+				Problem(check, pReport, szName, instruction.iLine, "error",
+						"%s: %g seconds is no time at all", szKeyword, fValue);
+			}
+			else if(fValue > AUTONOMOUS_PERIOD)
+			{
+				Problem(check, pReport, szName, instruction.iLine, "warning",
+						"%s: %g seconds is longer than autonomous (%gs)", szKeyword, fValue, AUTONOMOUS_PERIOD);
+			}
+			break;
+
+		case 'b':
+			if((fValue != 0.0) && (fValue != 1.0))
+			{
+				Problem(check, pReport, szName, instruction.iLine, "error",
+						"%s takes 0 or 1, not %g", szKeyword, fValue);
+			}
+			break;
+
+		case 'i':
+			if(fValue != floor(fValue))
+			{
+				Problem(check, pReport, szName, instruction.iLine, "error",
+						"%s takes a whole number, not %g", szKeyword, fValue);
+			}
+			break;
+
+		default:
+			break;
 		}
-		else
+
+		iGiven++;
+		pCursor = pEnd + strspn(pEnd, szDelimiters);
+	}
+
+	if(*pCursor != '\0')
+	{
+		Problem(check, pReport, szName, instruction.iLine, "warning",
+				"%s takes %d number%s, '%s' is ignored", szKeyword, iGiven, (iGiven == 1) ? "" : "s", pCursor);
+	}
+}
+
+///the longest this instruction can hold the script up, seconds
+static float WorstWait(const AutoInstruction &instruction, bool &bBounded)
+{
+	const char *pKind = szTokenParams[instruction.token];
+	int iParam = 0;
+
+	switch(tokenWaits[instruction.token])
+	{
+	case AUTO_WAIT_DELAY:
+		return(((instruction.iParams > 0) && (instruction.fParams[0] > 0.0)) ? instruction.fParams[0] : 0.0);
+
+	case AUTO_WAIT_RESPONSE:
+		// its own timeout if it was given one, or the one every answer gets
+
+		for(; *pKind != '\0'; ++pKind)
 		{
-			rStatus.append("raising tail");
+			if(*pKind == '|')
+			{
+				continue;
+			}
+
+			if(((*pKind == 'r') || (*pKind == 't')) && (iParam < instruction.iParams))
+			{
+				return(instruction.fParams[iParam]);
+			}
+
+			iParam++;
 		}
-		break;
 
-	case AUTO_TOKEN_REDSENSE:
-		if(!RedSense())
+		bBounded = false;
+		return(AUTONOMOUS_RESPONSE_TIMEOUT);
+
+	case AUTO_WAIT_SHOOT:
+		return(fmax(AUTONOMOUS_SHOOT_ARM_TIMEOUT, AUTONOMOUS_SHOOT_AIM_TIMEOUT) + SHOOTER_SEQUENCE_TIME);
+
+	case AUTO_WAIT_SEQUENCE:
+		return(SHOOTER_SEQUENCE_TIME);
+
+	default:
+		return(0.0);
+	}
+}
+
+AutoCheck AutoValidate(const AutoInstruction *program, int iLength, const char *szName, FILE *pReport)
+{
+	AutoCheck check = { 0, 0, 0.0, true };
+	bool bBegin = false;
+	bool bEnd = false;
+	bool bBounded;
+	int iParallelLine = -1;			// line of the open PARALLEL, -1 when there is none
+	float fBlock = 0.0;				// longest answer the open block waits for
+	float fWait;
+	const char *szKeyword;
+
+	for(int i = 0; i < iLength; ++i)
+	{
+		const AutoInstruction &instruction = program[i];
+
+		if(bEnd)
 		{
-			rStatus.append("sensing error");
+			Problem(check, pReport, szName, instruction.iLine, "warning",
+					"everything from here on comes after END and never runs");
+			break;
 		}
-		else
+
+		if(instruction.token == AUTO_TOKEN_LAST)
 		{
-			rStatus.append("finding goal with red");
+			szKeyword = instruction.szLine + strspn(instruction.szLine, szDelimiters);
+			Problem(check, pReport, szName, instruction.iLine, "error", "unknown command '%.*s'",
+					(int)strcspn(szKeyword, szDelimiters), szKeyword);
+			continue;
 		}
-		break;
 
-	case AUTO_TOKEN_START_DRIVE_FWD:
-		//Get speed and timeout
-		pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
+		CheckParams(instruction, check, pReport, szName);
 
-		if(pToken == NULL)
-		{
-			SmartDashboard::PutString("Auto Status","EARLY DEATH!");
-			PRINTAUTOERROR;
-			rStatus.append("missing token");
-			bReturn = false;
-		}
-		else
+		switch(instruction.token)
 		{
-			Message.params.autonomous.driveSpeed = atof(pToken);
+		case AUTO_TOKEN_BEGIN:
+			bBegin = true;
+			break;
 
-			Message.command = COMMAND_DRIVETRAIN_STRAIGHT;//simply drives forward
-			CommandNoResponse(DRIVETRAIN_QUEUE);
-		}
+		case AUTO_TOKEN_END:
+			bEnd = true;
+			break;
 
-		break;
+		case AUTO_TOKEN_PARALLEL:
+			if(iParallelLine >= 0)
+			{
+				Problem(check, pReport, szName, instruction.iLine, "error",
+						"PARALLEL inside the PARALLEL on line %d", iParallelLine + 1);
+			}
+			else
+			{
+				iParallelLine = instruction.iLine;
+				fBlock = 0.0;
+			}
+			break;
 
-	case AUTO_TOKEN_START_DRIVE_BCK:
-		//Get speed and timeout
-		pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
-		if(pToken == NULL)
-		{
-			SmartDashboard::PutString("Auto Status","EARLY DEATH!");
-			PRINTAUTOERROR;
-			rStatus.append("missing token");
-			bReturn = false;
-		}
-		else
-		{
-			Message.params.autonomous.driveSpeed = atof(pToken);
+		case AUTO_TOKEN_JOIN:
+			szKeyword = instruction.szText;
+
+			if(iParallelLine < 0)
+			{
+				Problem(check, pReport, szName, instruction.iLine, "error", "JOIN without PARALLEL");
+			}
+			else
+			{
+				// JOIN ANY waits this long too when none of them answer ok
+
+				check.fWorstCase += fBlock;
+				iParallelLine = -1;
+			}
+
+			if((*szKeyword != '\0') && ((strcspn(szKeyword, szDelimiters) != 3) ||
+					(strncmp(szKeyword, "ALL", 3) && strncmp(szKeyword, "ANY", 3))))
+			{
+				Problem(check, pReport, szName, instruction.iLine, "error",
+						"JOIN takes ALL or ANY, not '%s'", szKeyword);
+			}
+			break;
 
-			Message.command = COMMAND_DRIVETRAIN_STRAIGHT;	//simply drives back
-			CommandNoResponse(DRIVETRAIN_QUEUE);
+		default:
+			break;
 		}
-		break;
 
-	case AUTO_TOKEN_STOP_DRIVE:
-		Message.command = COMMAND_DRIVETRAIN_STOP;
-		CommandNoResponse(DRIVETRAIN_QUEUE);
-		break;
+		bBounded = true;
+		fWait = WorstWait(instruction, bBounded);
 
-	case AUTO_TOKEN_SHORT:
-		if(!Short())
+		if(!bBounded)
 		{
-			rStatus.append("short error");
+			Problem(check, pReport, szName, instruction.iLine, "note",
+					"%s has no timeout of its own, it may wait %gs for an answer",
+					szTokens[instruction.token], fWait);
+			check.bBounded = false;
+		}
+
+		if((iParallelLine >= 0) && (tokenWaits[instruction.token] == AUTO_WAIT_RESPONSE))
+		{
+			fBlock = fmax(fBlock, fWait);
 		}
 		else
 		{
-			rStatus.append("short shot");
+			if((iParallelLine >= 0) && !AutoParallelAllowed(instruction.token))
+			{
+				Problem(check, pReport, szName, instruction.iLine, "error",
+						"%s can not be part of the PARALLEL on line %d, it would run before the block is sent",
+						szTokens[instruction.token], iParallelLine + 1);
+			}
+
+			check.fWorstCase += fWait;
 		}
-		break;
+	}
 
-	case AUTO_TOKEN_JAWOPEN:
-		Message.command = COMMAND_SHOOTER_JAW_OPEN;
-		CommandNoResponse(SHOOTER_QUEUE);
-		break;
+	// how the script as a whole hangs together
 
-	case AUTO_TOKEN_JAWCLOSE:
-		Message.command = COMMAND_SHOOTER_JAW_CLOSE;
-		CommandNoResponse(SHOOTER_QUEUE);
-		break;
+	if(iParallelLine >= 0)
+	{
+		Problem(check, pReport, szName, iParallelLine, "error", "PARALLEL without JOIN, its commands are never sent");
+	}
 
-	default:
-		rStatus.append("unknown token");
-		break;
+	if(!bBegin && (iLength > 0))
+	{
+		Problem(check, pReport, szName, program[0].iLine, "warning",
+				"no BEGIN, the components are not told autonomous has started");
+	}
+
+	if(!bEnd && (iLength > 0))
+	{
+		Problem(check, pReport, szName, program[iLength - 1].iLine, "warning",
+				"no END, the components are not told autonomous is over");
+	}
+
+	if(check.fWorstCase > AUTONOMOUS_PERIOD)
+	{
+		Problem(check, pReport, szName, (iLength > 0) ? program[iLength - 1].iLine : 0, "warning",
+				"worst case %0.1fs is longer than autonomous (%gs)", check.fWorstCase, AUTONOMOUS_PERIOD);
 	}
 
-	if(bReturn)
+	if(pReport)
 	{
-		printf("%0.3lf %s\n", pDebugTimer->Get(), rStatement.c_str());
+		fprintf(pReport, "%s: %d error%s, %d warning%s, worst case %0.1fs of %gs\n", szName,
+				check.iErrors, (check.iErrors == 1) ? "" : "s", check.iWarnings, (check.iWarnings == 1) ? "" : "s",
+				check.fWorstCase, AUTONOMOUS_PERIOD);
 	}
 
-	SmartDashboard::PutBoolean("bReturn", bReturn);
-	return (bReturn);
+	return(check);
 }
@@ -5,50 +5,137 @@
 #ifndef AUTOPARSER_H
 #define AUTOPARSER_H
 
-// any line in the parser file that begins with a space or a # is skipped
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// any line in the parser file that is blank or whose first word starts with a # is skipped,
+// spaces, tabs and carriage returns count as blank
 
 const char sComment = '#';
-const char szDelimiters[] = " ,[]()";
+const char szDelimiters[] = " ,[]()\t\r\n";
+
+//from 2014
+const float MAX_VELOCITY_PARAM = 1.0;
+const float MAX_DISTANCE_PARAM = 100.0;
 
+///every command in the language, in enum order: AUTO_TOKEN(name, keyword, params, wait)
 ///N - doesn't need a response; R - needs a response; _ - contained within auto thread
+///add a command here and it gets its AUTO_TOKEN_ value, its keyword, its lookup and its checks
+///
+///params has a letter for each number the command takes, the ones after a '|' may be left out:
+///  v speed, no more than MAX_VELOCITY_PARAM either way   d distance, inches
+///  a angle, degrees, no more than 360 either way         s seconds, more than 0
+///  t seconds the component takes at most, then answers    r seconds the script waits for the answer
+///  b 0 or 1                                               i a whole number
+///  * free text, not checked here
+///wait is how long the script can be held up by it, see AutoWait
+#define AUTO_TOKEN_TABLE(AUTO_TOKEN) \
+	AUTO_TOKEN(START_AUTO,		"START",			"",		NONE)		/*R	send message to all components to set up for Autonomous*/ \
+	AUTO_TOKEN(FINISH_AUTO,		"FINISH",			"",		NONE)		/*R	send message to all components that Autonomous is done*/ \
+	AUTO_TOKEN(MODE,			"MODE",				"i",	NONE)		/*	mode block number, number(integer)*/ \
+	AUTO_TOKEN(DEBUG,			"DEBUG",			"b",	NONE)		/*	debug mode, 0 = off, 1 = on*/ \
+	AUTO_TOKEN(MESSAGE,			"MESSAGE",			"*",	NONE)		/*	print debug message*/ \
+	AUTO_TOKEN(BEGIN,			"BEGIN",			"",		NONE)		/*	mark beginning of mode block*/ \
+	AUTO_TOKEN(END,				"END",				"",		NONE)		/*	mark end of mode block*/ \
+	AUTO_TOKEN(PARALLEL,		"PARALLEL",			"",		NONE)		/*	the commands up to JOIN are sent all at once*/ \
+	AUTO_TOKEN(JOIN,			"JOIN",				"*",	NONE)		/*	(ALL or ANY) wait for every command of the block, or the first*/ \
+	AUTO_TOKEN(DELAY,			"DELAY",			"s",	DELAY)		/*	delay (seconds - float)*/ \
+	AUTO_TOKEN(MOVE,			"MOVE",				"vv",	NONE)		/*N	move (left & right PWM - float)*/ \
+	AUTO_TOKEN(MMOVE,			"MMOVE",			"vd|r",	RESPONSE)	/*R	mmove (speed) (inches - float) (timeout)*/ \
+	AUTO_TOKEN(MLINE,			"MLINE",			"vd|r",	RESPONSE)	/*R	mline (speed) (inches - float) (timeout)*/ \
+	AUTO_TOKEN(TURN,			"TURN",				"at",	RESPONSE)	/*R	turn (degrees - float) (timeout)*/ \
+	AUTO_TOKEN(STRAIGHT,		"STRAIGHT",			"vs",	NONE)		/*N	straight drive (speed) (duration)*/ \
+	AUTO_TOKEN(SEARCH,			"SEARCH",			"",		RESPONSE) \
+	AUTO_TOKEN(AIM,				"AIM",				"",		RESPONSE) \
+	AUTO_TOKEN(INTAKE,			"INTAKE",			"",		NONE) \
+	AUTO_TOKEN(INTAKESTOP,		"STOPINTAKE",		"",		NONE) \
+	AUTO_TOKEN(RIDE,			"RIDE",				"",		NONE) \
+	AUTO_TOKEN(LOWERINTAKE,		"LOWEST",			"",		NONE) \
+	AUTO_TOKEN(AFTERSHOOT,		"AFTERSHOOT",		"",		NONE) \
+	AUTO_TOKEN(THROWUP,			"THROWUP",			"",		RESPONSE) \
+	AUTO_TOKEN(SHOOT,			"SHOOT",			"",		SHOOT) \
+	AUTO_TOKEN(SETANGLE,		"SETANGLE",			"",		NONE) \
+	AUTO_TOKEN(LOWER,			"LOWER",			"",		NONE) \
+	AUTO_TOKEN(RAISE,			"RAISE",			"",		NONE) \
+	AUTO_TOKEN(TAILDOWN,		"TAILDOWN",			"",		NONE) \
+	AUTO_TOKEN(TAILUP,			"TAILUP",			"",		NONE) \
+	AUTO_TOKEN(REDSENSE,		"REDSENSE",			"",		RESPONSE) \
+	AUTO_TOKEN(START_DRIVE_FWD,	"STARTDRIVEFWD",	"v",	NONE)		/*	(drive speed)*/ \
+	AUTO_TOKEN(START_DRIVE_BCK,	"STARTDRIVEBCK",	"v",	NONE)		/*	(drive speed)*/ \
+	AUTO_TOKEN(STOP_DRIVE,		"STOPDRIVE",		"",		NONE) \
+	AUTO_TOKEN(SHORT,			"SHORT",			"",		SEQUENCE) \
+	AUTO_TOKEN(JAWOPEN,			"JAWOPEN",			"",		NONE) \
+	AUTO_TOKEN(JAWCLOSE,		"JAWCLOSE",			"",		NONE)
+
+///how long one command can hold the script up
+typedef enum AUTO_WAIT
+{
+	AUTO_WAIT_NONE,				//!< sends and goes on
+	AUTO_WAIT_DELAY,			//!< its first number, in seconds
+	AUTO_WAIT_RESPONSE,			//!< until the answer: its r or t, else AUTONOMOUS_RESPONSE_TIMEOUT
+	AUTO_WAIT_SHOOT,			//!< arm and aim together, then the shooter sequence
+	AUTO_WAIT_SEQUENCE			//!< the shooter sequence
+} AUTO_WAIT;
+
 typedef enum AUTO_COMMAND_TOKENS
 {
-	AUTO_TOKEN_START_AUTO,			//!<R	send message to all components to set up for Autonomous
-	AUTO_TOKEN_FINISH_AUTO,			//!<R	send message to all components that Autonomous is done
-	AUTO_TOKEN_MODE,				//!<	mode block number, number(integer)
-	AUTO_TOKEN_DEBUG,				//!<	debug mode, 0 = off, 1 = on
-	AUTO_TOKEN_MESSAGE,				//!<	print debug message
-	AUTO_TOKEN_BEGIN,				//!<	mark beginning of mode block
-	AUTO_TOKEN_END,					//!<	mark end of mode block
-	AUTO_TOKEN_DELAY,				//!<	delay (seconds - float)
-	AUTO_TOKEN_MOVE,				//!<N	move (left & right PWM - float)
-	AUTO_TOKEN_MMOVE,				//!<R	mmove (speed) (inches - float)
-	AUTO_TOKEN_MLINE,				//!<R	mline (speed) (inches - float)
-	AUTO_TOKEN_TURN,				//!<R	turn (degrees - float) (timeout)
-	AUTO_TOKEN_STRAIGHT,			//!<R	straight drive (speed) (duration)
-	AUTO_TOKEN_SEARCH,
-	AUTO_TOKEN_AIM,
-	AUTO_TOKEN_INTAKE,
-	AUTO_TOKEN_INTAKESTOP,
-	AUTO_TOKEN_RIDE,
-	AUTO_TOKEN_LOWERINTAKE,
-	AUTO_TOKEN_AFTERSHOOT,
-	AUTO_TOKEN_THROWUP,
-	AUTO_TOKEN_SHOOT,
-	AUTO_TOKEN_SETANGLE,
-	AUTO_TOKEN_LOWER,
-	AUTO_TOKEN_RAISE,
-	AUTO_TOKEN_TAILDOWN,
-	AUTO_TOKEN_TAILUP,
-	AUTO_TOKEN_REDSENSE,
-	AUTO_TOKEN_START_DRIVE_FWD,
-	AUTO_TOKEN_START_DRIVE_BCK,
-	AUTO_TOKEN_STOP_DRIVE,
-	AUTO_TOKEN_SHORT,
-	AUTO_TOKEN_JAWOPEN,
-	AUTO_TOKEN_JAWCLOSE,
+#define AUTO_TOKEN_ENUM(name, keyword, params, wait) AUTO_TOKEN_##name,
+	AUTO_TOKEN_TABLE(AUTO_TOKEN_ENUM)
+#undef AUTO_TOKEN_ENUM
 	AUTO_TOKEN_LAST
 } AUTO_COMMAND_TOKENS;
 
+extern const char *szTokens[];		//!< keyword of each token, "NOP" for AUTO_TOKEN_LAST
+extern const char *szTokenParams[];	//!< params of each token, see AUTO_TOKEN_TABLE
+extern const AUTO_WAIT tokenWaits[];
+
+///FNV-1a of uLength characters, the same at compile time and at run time
+constexpr uint32_t AutoKeywordHash(const char *szKeyword, size_t uLength, uint32_t uHash = 2166136261u)
+{
+	return((uLength == 0) ? uHash : AutoKeywordHash(szKeyword + 1, uLength - 1, (uHash ^ (uint8_t)*szKeyword) * 16777619u));
+}
+
+///the token whose keyword is exactly these uLength characters, AUTO_TOKEN_LAST if none is
+AUTO_COMMAND_TOKENS AutoFindToken(const char *szKeyword, size_t uLength);
+
+///false for a command that can not go in a PARALLEL block.  JOIN sends the block's commands in
+///order, one that waits or runs in the script itself would happen before any of them
+bool AutoParallelAllowed(AUTO_COMMAND_TOKENS token);
+
+const int AUTO_MAX_PARAMS = 4;		// numbers past this many on a line are ignored
+
+///one script line, decoded once when the script is loaded so running it is only a dispatch
+struct AutoInstruction
+{
+	AUTO_COMMAND_TOKENS token;		//!< AUTO_TOKEN_LAST if the line has no keyword we know
+	int iLine;						//!< script line it came from, the first is 0
+	int iParams;					//!< how many numbers followed the keyword
+	float fParams[AUTO_MAX_PARAMS];
+	const char *szLine;				//!< the whole line, points into the script text
+	const char *szText;				//!< the line after the keyword, what MESSAGE prints
+};
+
+///false for a line that does nothing (blank or a comment), nothing is filled in then
+bool AutoCompileLine(const char *szLine, int iLine, AutoInstruction &instruction);
+
+///compiles a whole script, cutting szText into lines where they end.  program needs room
+///for as many instructions as there are lines, comments and empty lines are left out
+int AutoCompileText(char *szText, AutoInstruction *program);
+
+///what AutoValidate() made of a script
+struct AutoCheck
+{
+	int iErrors;					//!< lines that will not do what they say, or not run at all
+	int iWarnings;					//!< lines that run, but maybe not as meant
+	float fWorstCase;				//!< seconds, every command held up as long as it can be
+	bool bBounded;					//!< false if a wait had no timeout and counted AUTONOMOUS_RESPONSE_TIMEOUT
+};
+
+///checks every instruction against its command's params and the block structure and adds up
+///the worst case time.  Each problem goes to pReport as "szName:line: error: ...", the way a
+///compiler would put it, followed by the worst case against AUTONOMOUS_PERIOD
+AutoCheck AutoValidate(const AutoInstruction *program, int iLength, const char *szName, FILE *pReport);
+
 #endif  // AUTOPARSER_H
 
@@ -17,34 +17,57 @@
 #include <fstream>
 #include <string>
 #include <math.h>
+#include <limits.h>
+#include <algorithm>
+#include <chrono>
+#include <future>
 #include "ShooterSequence.h"
 
 //Robot
 #include <RobotParams.h>
+#include <RobotClock.h>
 
 using namespace std;
 
 extern "C" {
 }
 
-bool Autonomous::CommandResponse(const char *szQueueName) {
-	int iPipeXmt;
+bool Autonomous::CommandResponse(const char *szQueueName, float fTimeout) {
+	MessageQueue *pQueueXmt;
+	std::future<MessageCommand> response;
+	unsigned uCorrelation;
 	bool bReturn = true;
 
-	iPipeXmt = open(szQueueName, O_WRONLY);
-	wpi_assert(iPipeXmt > 0);
+	// inside a PARALLEL block it is only written down, JOIN sends the lot
+
+	if(bInParallel)
+	{
+		parallel.push_back(CommandBranch(szQueueName, Message.command, fTimeout));
+		parallel.back().message = Message;
+		return(true);
+	}
+
+	pQueueXmt = MessageQueue::GetEndpoint(szQueueName);
+	wpi_assert(pQueueXmt);
 
 	Message.replyQ = AUTONOMOUS_QUEUE;
-	write(iPipeXmt, (char*) &Message, sizeof(RobotMessage));
-	close(iPipeXmt);
+	response = responses.Expect(&Message);
+	uCorrelation = Message.uCorrelation;
+	pQueueXmt->Send(&Message);
 
-	bReceivedCommandResponse = false;
+	// sleep until tAuto hands us the answer, not spin on a flag it sets
 
-	while (!bReceivedCommandResponse)
+	if(response.wait_for(std::chrono::microseconds(RobotClock::RealUs((long long)(fTimeout * 1000000.0))))
+			!= std::future_status::ready)
 	{
-		//purposefully empty
+		responses.Cancel(uCorrelation);
+		SmartDashboard::PutString("Auto Status","RESPONSE TIMEOUT!");
+		PRINTAUTOERROR;
+		return(false);
 	}
 
+	ReceivedCommand = response.get();
+
 	if(iAutoDebugMode)
 	{
 		printf("%0.3lf Response received\n", pDebugTimer->Get());
@@ -66,68 +89,167 @@ bool Autonomous::CommandResponse(const char *szQueueName) {
 }
 
 
-//UNTESTED
-//USAGE: MultiCommandResponse({DRIVETRAIN_QUEUE, CONVEYOR_QUEUE}, {COMMAND_DRIVETRAIN_STRAIGHT, COMMAND_CONVEYOR_SEEK_TOTE});
-bool Autonomous::MultiCommandResponse(vector<char*> szQueueNames, vector<MessageCommand> commands) {
-	//wait for several commands at once
-	//check that queue list is as long as command list
-	if(szQueueNames.size() != commands.size())
-	{
-		SmartDashboard::PutString("Auto Status","MULTICOMMAND error!");
-		return false;
-	}
+//Sends every command at once and waits for all of them to answer.  Gives up as soon as
+//one answers with an error or runs past its own timeout, the others are left to finish
+//on their own and their late answers are dropped.
+//With bAny it waits only for the first one to answer ok, and fails only if none of them do.
+//Branches marked bNoResponse are sent in their turn with the others and not waited for.
+//USAGE: vector<CommandBranch> branches = {CommandBranch(DRIVETRAIN_QUEUE, COMMAND_AUTONOMOUS_SHOOT, 6.0),
+//                                         CommandBranch(ARM_QUEUE, COMMAND_AUTONOMOUS_SHOOT, 3.0)};
+//       MultiCommandResponse(branches);
+bool Autonomous::MultiCommandResponse(vector<CommandBranch> &branches, bool bAny) {
 	bool bReturn = true;
-	int iPipeXmt;
-	uResponseCount = 0;
-	//vector<int> iPipesXmt = new vector<int>();
-	//send messages to each component
-	for (unsigned int i = 0; i < szQueueNames.size(); i++)
+	bool bDone = false;
+	unsigned uSucceeded = 0;
+	MessageQueue *pQueueXmt;
+	vector<std::future<MessageCommand> > replies(branches.size());
+	vector<unsigned> correlations(branches.size());
+	vector<bool> outstanding(branches.size(), true);
+	unsigned uOutstanding = branches.size();
+	unsigned uAnswering = 0;
+	unsigned uSeen;
+	long long llStartUs = RobotClock::NowUs();
+	long long llNowUs;
+	long long llNextDeadlineUs;
+	vector<long long> deadlines(branches.size());
+
+	//scatter in order, each command gets its own correlation id and deadline
+	for (unsigned int i = 0; i < branches.size(); i++)
 	{
-		iPipeXmt = open(szQueueNames[i], O_WRONLY);
-		wpi_assert(iPipeXmt > 0);
+		pQueueXmt = MessageQueue::GetEndpoint(branches[i].szQueueName);
+		wpi_assert(pQueueXmt);
 
-		Message.replyQ = AUTONOMOUS_QUEUE;
-		Message.command = commands[i];
-		write(iPipeXmt, (char*) &Message, sizeof(RobotMessage));
-		close(iPipeXmt);
-	}
+		if (branches[i].bNoResponse)
+		{
+			branches[i].message.uCorrelation = CORRELATION_NONE;
+			pQueueXmt->Send(&branches[i].message);
+			outstanding[i] = false;
+			uOutstanding--;
+			continue;
+		}
 
-	bReceivedCommandResponse = false;
+		uAnswering++;
+		branches[i].message.replyQ = AUTONOMOUS_QUEUE;
+		replies[i] = responses.Expect(&branches[i].message);
+		correlations[i] = branches[i].message.uCorrelation;
+		deadlines[i] = llStartUs + (long long)(branches[i].fTimeout * 1000000.0);
+		pQueueXmt->Send(&branches[i].message);
+	}
 
-	while (uResponseCount < szQueueNames.size())
+	//gather, sleeping until some reply arrives or the nearest deadline passes
+	while ((uOutstanding > 0) && !bDone)
 	{
-		while (!bReceivedCommandResponse)
+		uSeen = responses.GetCompletions();
+		llNowUs = RobotClock::NowUs();
+		llNextDeadlineUs = LLONG_MAX;
+
+		for (unsigned int i = 0; i < branches.size(); i++)
 		{
-			//purposefully empty
+			if (!outstanding[i])
+			{
+				continue;
+			}
+
+			if (replies[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+			{
+				branches[i].response = replies[i].get();
+				branches[i].fElapsed = (llNowUs - llStartUs) / 1000000.0;
+				outstanding[i] = false;
+				uOutstanding--;
+
+				if (branches[i].response == COMMAND_AUTONOMOUS_RESPONSE_OK)
+				{
+					uSucceeded++;
+					bDone |= bAny;
+				}
+				else if (!bAny)
+				{
+					bReturn = false;
+					bDone = true;
+				}
+			}
+			else if (llNowUs >= deadlines[i])
+			{
+				responses.Cancel(correlations[i]);
+				branches[i].bTimedOut = true;
+				branches[i].fElapsed = branches[i].fTimeout;
+				outstanding[i] = false;
+				uOutstanding--;
+
+				if (!bAny)
+				{
+					bReturn = false;
+					bDone = true;
+				}
+			}
+			else
+			{
+				llNextDeadlineUs = std::min(llNextDeadlineUs, deadlines[i]);
+			}
 		}
 
-		if(iAutoDebugMode)
+		if ((uOutstanding > 0) && !bDone)
 		{
-			printf("%0.3lf Response received\n", pDebugTimer->Get());
+			responses.WaitForCompletion(uSeen, llNextDeadlineUs);
 		}
+	}
+
+	if (bAny && (uAnswering > 0) && (uSucceeded == 0))
+	{
+		bReturn = false;
+	}
 
-		if (ReceivedCommand == COMMAND_AUTONOMOUS_RESPONSE_OK)
+	//whatever is still running after a failure, or after the first answer with bAny, is abandoned
+	for (unsigned int i = 0; i < branches.size(); i++)
+	{
+		if (outstanding[i])
 		{
-			SmartDashboard::PutString("Auto Status", "auto ok");
-			bReturn = true;
+			responses.Cancel(correlations[i]);
 		}
-		else if (ReceivedCommand == COMMAND_AUTONOMOUS_RESPONSE_ERROR)
+
+		if(iAutoDebugMode || !bReturn)
 		{
-			SmartDashboard::PutString("Auto Status", "EARLY DEATH!");
-			bReturn = false;
+			printf("%0.3lf   %-12s %-28s %-8s %0.3fs of %0.3fs\n", pDebugTimer->Get(),
+					branches[i].szQueueName, GetCommandName(branches[i].message.command),
+					branches[i].bNoResponse ? "sent" :
+					branches[i].bTimedOut ? "TIMEOUT" : (outstanding[i] ? "ABANDONED" :
+					(branches[i].response == COMMAND_AUTONOMOUS_RESPONSE_OK ? "ok" : "ERROR")),
+					branches[i].fElapsed, branches[i].fTimeout);
 		}
 	}
+
+	if (bReturn)
+	{
+		SmartDashboard::PutString("Auto Status", "auto ok");
+	}
+	else
+	{
+		SmartDashboard::PutString("Auto Status", "EARLY DEATH!");
+		PRINTAUTOERROR;
+	}
+
+	SmartDashboard::PutNumber("Auto Multi Command Time", (RobotClock::NowUs() - llStartUs) / 1000000.0);
 	return bReturn;
 }
 
 bool Autonomous::CommandNoResponse(const char *szQueueName) {
-	int iPipeXmt;
+	MessageQueue *pQueueXmt;
+
+	// inside a PARALLEL block it waits its turn, JOIN sends the lot in order
 
-	iPipeXmt = open(szQueueName, O_WRONLY);
-	wpi_assert(iPipeXmt > 0);
+	if(bInParallel)
+	{
+		parallel.push_back(CommandBranch(szQueueName, Message.command, 0.0));
+		parallel.back().message = Message;
+		parallel.back().bNoResponse = true;
+		return(true);
+	}
 
-	write(iPipeXmt, (char*) &Message, sizeof(RobotMessage));
-	close(iPipeXmt);
+	pQueueXmt = MessageQueue::GetEndpoint(szQueueName);
+	wpi_assert(pQueueXmt);
+
+	Message.uCorrelation = CORRELATION_NONE;
+	pQueueXmt->Send(&Message);
 	return (true);
 }
 
@@ -159,39 +281,79 @@ bool Autonomous::Finish()
 	return(false);
 }
 
-bool Autonomous::Begin(char *pCurrLinePos)
+bool Autonomous::Begin()
 {
 	//tell all the components who may need to know that auto is beginning
 	Message.command = COMMAND_AUTONOMOUS_RUN;
-	return (CommandNoResponse(DRIVETRAIN_QUEUE));
+	MessageBus::Publish(MESSAGE_TOPIC_AUTONOMOUS, &Message);
+	return (true);
 }
 
-bool Autonomous::End(char *pCurrLinePos)
+bool Autonomous::End()
 {
 	//tell all the components who may need to know that auto is beginning
 	Message.command = COMMAND_AUTONOMOUS_COMPLETE;
-	CommandNoResponse(DRIVETRAIN_QUEUE);
+	MessageBus::Publish(MESSAGE_TOPIC_AUTONOMOUS, &Message);
 	return (true);
 }
 
+bool Autonomous::Parallel()
+{
+	// from here to JOIN, commands are written down instead of being sent and
+	// waited for one at a time.  JOIN sends them in the order they were written
+
+	if(bInParallel)
+	{
+		SmartDashboard::PutString("Auto Status","PARALLEL INSIDE PARALLEL!");
+		PRINTAUTOERROR;
+		return (false);
+	}
+
+	parallel.clear();
+	bInParallel = true;
+	return (true);
+}
+
+bool Autonomous::Join(const AutoInstruction &instruction)
+{
+	bool bAny;
+
+	// JOIN or JOIN ALL waits for every command of the block, JOIN ANY for the first
+
+	if(!bInParallel)
+	{
+		SmartDashboard::PutString("Auto Status","JOIN WITHOUT PARALLEL!");
+		PRINTAUTOERROR;
+		return (false);
+	}
+
+	bAny = !strncmp(instruction.szText, "ANY", 3) && (instruction.szText[3] == '\0' ||
+			strchr(szDelimiters, instruction.szText[3]));
+	bInParallel = false;
+	return (MultiCommandResponse(parallel, bAny));
+}
+
 bool Autonomous::Stop(char *pCurrLinePos) {
 	//tell those who need to know that the autonomous behavior is over - reset variables
 	Message.command = COMMAND_DRIVETRAIN_STOP;
 	return (CommandNoResponse(DRIVETRAIN_QUEUE));
 }
 
-bool Autonomous::Move(char *pCurrLinePos) {
-	char *pToken;
+bool Autonomous::Move(const AutoInstruction &instruction) {
 	float fLeft;
 	float fRight;
 
-	// parse remainder of line to get length to move
+	// left and right speed
 
-	pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
-	fLeft = atof(pToken);
+	if(instruction.iParams < 2)
+	{
+		SmartDashboard::PutString("Auto Status","DEATH BY PARAMS!");
+		PRINTAUTOERROR;
+		return (false);
+	}
 
-	pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
-	fRight = atof(pToken);
+	fLeft = instruction.fParams[0];
+	fRight = instruction.fParams[1];
 
 	if ((fabs(fLeft) > MAX_VELOCITY_PARAM)
 			|| (fabs(fRight) > MAX_VELOCITY_PARAM))
@@ -199,118 +361,67 @@ bool Autonomous::Move(char *pCurrLinePos) {
 		return (false);
 	}
 	Message.command = COMMAND_DRIVETRAIN_AUTO_MOVE;
-	Message.params.tankDrive.left = fLeft;
-	Message.params.tankDrive.right = fRight;
+	GetParams<COMMAND_DRIVETRAIN_AUTO_MOVE>(Message).left = fLeft;
+	GetParams<COMMAND_DRIVETRAIN_AUTO_MOVE>(Message).right = fRight;
 
 	return (CommandNoResponse(DRIVETRAIN_QUEUE));
 }
 
-bool Autonomous::MeasuredMove(char *pCurrLinePos) {
+bool Autonomous::MeasuredMove(const AutoInstruction &instruction) {
 
-	char *pToken;
-	float fDistance;
-	float fSpeed;
+	// speed and distance to move
 
-	// parse remainder of line to get length to move
-
-	pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
-
-	if(pToken == NULL)
-	{
-		SmartDashboard::PutString("Auto Status","EARLY DEATH!");
-		return (false);
-	}
-
-	fSpeed = atof(pToken);
-
-	pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
-
-	if(pToken == NULL)
+	if(instruction.iParams < 2)
 	{
 		SmartDashboard::PutString("Auto Status","EARLY DEATH!");
 		return (false);
 	}
 
-	fDistance = atof(pToken);
-
 	// send the message to the drive train
 
 	Message.command = COMMAND_DRIVETRAIN_MSTRAIGHT;
-	Message.params.autonomous.driveSpeed = fSpeed;
-	Message.params.autonomous.driveDistance = fDistance;
+	GetParams<COMMAND_DRIVETRAIN_MSTRAIGHT>(Message).driveSpeed = instruction.fParams[0];
+	GetParams<COMMAND_DRIVETRAIN_MSTRAIGHT>(Message).driveDistance = instruction.fParams[1];
 
-	return (CommandResponse(DRIVETRAIN_QUEUE));
+	return (CommandResponse(DRIVETRAIN_QUEUE,
+			(instruction.iParams > 2) ? instruction.fParams[2] : AUTONOMOUS_RESPONSE_TIMEOUT));
 }
 
-bool Autonomous::MeasuredMoveToLine(char *pCurrLinePos) {
-
-	char *pToken;
-	float fDistance;
-	float fSpeed;
-
-	// parse remainder of line to get length to move
-
-	pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
-
-	if(pToken == NULL)
-	{
-		SmartDashboard::PutString("Auto Status","EARLY DEATH!");
-		return (false);
-	}
-
-	fSpeed = atof(pToken);
+bool Autonomous::MeasuredMoveToLine(const AutoInstruction &instruction) {
 
-	pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
+	// speed and distance to move
 
-	if(pToken == NULL)
+	if(instruction.iParams < 2)
 	{
 		SmartDashboard::PutString("Auto Status","EARLY DEATH!");
 		return (false);
 	}
 
-	fDistance = atof(pToken);
-
 	// send the message to the drive train
 
 	Message.command = COMMAND_DRIVETRAIN_MLINE;
-	Message.params.autonomous.driveSpeed = fSpeed;
-	Message.params.autonomous.driveDistance = fDistance;
+	GetParams<COMMAND_DRIVETRAIN_MLINE>(Message).driveSpeed = instruction.fParams[0];
+	GetParams<COMMAND_DRIVETRAIN_MLINE>(Message).driveDistance = instruction.fParams[1];
 
-	return (CommandResponse(DRIVETRAIN_QUEUE));
+	return (CommandResponse(DRIVETRAIN_QUEUE,
+			(instruction.iParams > 2) ? instruction.fParams[2] : AUTONOMOUS_RESPONSE_TIMEOUT));
 }
 
-bool Autonomous::Straight(char *pCurrLinePos) {
-	char *pToken;
-	float fSpeed;
-	float fTime;
-
-	// parse remainder of line to get length to move
-
-	pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
-
-	if(pToken == NULL)
-	{
-		SmartDashboard::PutString("Auto Status","DEATH BY PARAMS!");
-		PRINTAUTOERROR;
-		return (false);
-	}
+bool Autonomous::Straight(const AutoInstruction &instruction) {
 
-	fSpeed = atof(pToken);
-	pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
+	// speed and how long to drive
 
-	if(pToken == NULL)
+	if(instruction.iParams < 2)
 	{
 		SmartDashboard::PutString("Auto Status","DEATH BY PARAMS!");
 		PRINTAUTOERROR;
 		return (false);
 	}
 
-	fTime = atof(pToken);
-
 	// send the message to the drive train
 	Message.command = COMMAND_DRIVETRAIN_STRAIGHT;
-	Message.params.autonomous.driveSpeed = fSpeed;
-	Message.params.autonomous.timeout = fTime;
+	GetParams<COMMAND_DRIVETRAIN_STRAIGHT>(Message).driveSpeed = instruction.fParams[0];
+	GetParams<COMMAND_DRIVETRAIN_STRAIGHT>(Message).timeout = instruction.fParams[1];
 	return (CommandNoResponse(DRIVETRAIN_QUEUE));
 }
 
@@ -343,20 +454,17 @@ bool Autonomous::Throwup(){
 }
 
 bool Autonomous::Shoot(){
-	Message.command = COMMAND_AUTONOMOUS_SHOOT;
-	CommandResponse(ARM_QUEUE);
-	Message.command = COMMAND_AUTONOMOUS_SHOOT;
-	CommandResponse(DRIVETRAIN_QUEUE);
-	printf("getting instance\n");
-	ShooterSequence ss = ShooterSequence();
-	ss.Run();
-	printf("got instance\n");
+	// raise the arm while the drivetrain aims, neither needs the other
+	vector<CommandBranch> branches;
+	branches.push_back(CommandBranch(ARM_QUEUE, COMMAND_AUTONOMOUS_SHOOT, AUTONOMOUS_SHOOT_ARM_TIMEOUT));
+	branches.push_back(CommandBranch(DRIVETRAIN_QUEUE, COMMAND_AUTONOMOUS_SHOOT, AUTONOMOUS_SHOOT_AIM_TIMEOUT));
+	MultiCommandResponse(branches);
+	pShooterSequence->Run();
 	return true;
 }
 
 bool Autonomous::Short(){
-	ShooterSequence ss = ShooterSequence();
-	ss.Run();
+	pShooterSequence->Run();
 	return true;
 }
 
@@ -390,35 +498,257 @@ bool Autonomous::RedSense(){
 	return(CommandResponse(DRIVETRAIN_QUEUE));
 }
 
-bool Autonomous::Turn(char *pCurrLinePos) {
-	char *pToken;
-	float fAngle;
-	float fTimeout;
+bool Autonomous::Turn(const AutoInstruction &instruction) {
 
-	// parse remainder of line to get target angle and timeout
-	pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
+	// target angle and timeout
 
-	if(pToken == NULL)
+	if(instruction.iParams < 2)
 	{
 		SmartDashboard::PutString("Auto Status","DEATH BY PARAMS!");
 		return (false);
 	}
 
-	fAngle = atof(pToken);
+	// send the message to the drive train
+	Message.command = COMMAND_DRIVETRAIN_TURN;
+	GetParams<COMMAND_DRIVETRAIN_TURN>(Message).turnAngle = instruction.fParams[0];
+	GetParams<COMMAND_DRIVETRAIN_TURN>(Message).timeout = instruction.fParams[1];
+	return (CommandResponse(DRIVETRAIN_QUEUE));
+}
 
-	pToken = strtok_r(pCurrLinePos, szDelimiters, &pCurrLinePos);
+bool Autonomous::Evaluate(std::string rStatement) {
+	AutoInstruction instruction;
 
-	if(pToken == NULL)
-	{
-		SmartDashboard::PutString("Auto Status","DEATH BY PARAMS!");
+	if(rStatement.empty()) {
+		printf("statement is empty");
 		return (false);
 	}
 
-	fTimeout = atof(pToken);
+	// the old way, decoded at the moment it runs
 
-	// send the message to the drive train
-	Message.command = COMMAND_DRIVETRAIN_TURN;
-	Message.params.autonomous.turnAngle = fAngle;
-	Message.params.autonomous.timeout = fTimeout;
-	return (CommandResponse(DRIVETRAIN_QUEUE));
+	if(!AutoCompileLine(rStatement.c_str(), lineNumber, instruction)) {
+		return (false);
+	}
+
+	return (Execute(instruction));
+}
+
+bool Autonomous::Execute(const AutoInstruction &instruction) {
+	bool bReturn = false; ///setting this to true WILL cause auto parsing to quit!
+
+	if(instruction.token == AUTO_TOKEN_LAST) {
+		// no valid token found, check script spelling
+		printf("%0.3lf %s\n", pDebugTimer->Get(), instruction.szLine);
+		return (true);
+	}
+
+	// if we are paused wait here before executing a real command
+
+	while(bPauseAutoMode)
+	{
+		Wait(0.02);
+	}
+
+	// execute the proper command
+
+	if(iAutoDebugMode)
+	{
+		printf("%0.3lf %s %s\n", pDebugTimer->Get(), szTokens[instruction.token], instruction.szText);
+	}
+
+	// a block only holds commands for JOIN to send, this one would run right
+	// here ahead of them.  AutoValidate() reports it when the script loads
+
+	if(bInParallel && !AutoParallelAllowed(instruction.token))
+	{
+		printf("%0.3lf %s can not be part of a PARALLEL block, skipped\n", pDebugTimer->Get(),
+				szTokens[instruction.token]);
+		SmartDashboard::PutString("Auto Status","NOT IN PARALLEL!");
+		PRINTAUTOERROR;
+		return(false);
+	}
+
+	switch (instruction.token)
+	{
+
+	case AUTO_TOKEN_START_AUTO:
+		Start();
+		break;
+
+	case AUTO_TOKEN_FINISH_AUTO:
+		Finish();
+		break;
+
+	case AUTO_TOKEN_BEGIN:
+		Begin();
+		break;
+
+	case AUTO_TOKEN_END:
+		if(bInParallel)
+		{
+			// nothing of the block was sent, say so rather than drop it quietly
+			printf("%0.3lf PARALLEL without JOIN, %u commands not sent\n", pDebugTimer->Get(),
+					(unsigned)parallel.size());
+			bInParallel = false;
+		}
+
+		End();
+		bReturn = true;
+		break;
+
+	case AUTO_TOKEN_PARALLEL:
+		Parallel();
+		break;
+
+	case AUTO_TOKEN_JOIN:
+		Join(instruction);
+		break;
+
+	case AUTO_TOKEN_DEBUG:
+		if(instruction.iParams > 0)
+		{
+			iAutoDebugMode = (int)instruction.fParams[0];
+		}
+		break;
+
+	case AUTO_TOKEN_MESSAGE:
+		printf("%0.3lf %03d: %s\n", pDebugTimer->Get(), instruction.iLine, instruction.szText);
+		break;
+
+	case AUTO_TOKEN_DELAY:
+		if(instruction.iParams > 0)
+		{
+			Delay(instruction.fParams[0]);
+		}
+		break;
+
+	case AUTO_TOKEN_MOVE:
+		Move(instruction);
+		break;
+
+	case AUTO_TOKEN_MMOVE:
+		MeasuredMove(instruction);
+		break;
+
+	case AUTO_TOKEN_MLINE:
+		MeasuredMoveToLine(instruction);
+		break;
+
+	case AUTO_TOKEN_TURN:
+		Turn(instruction);
+		break;
+
+	case AUTO_TOKEN_STRAIGHT:
+		Straight(instruction);
+		break;
+
+	case AUTO_TOKEN_SEARCH:
+		printf("search token\n");
+		Search();
+		break;
+
+	case AUTO_TOKEN_AIM:
+		Aim();
+		break;
+
+	case AUTO_TOKEN_INTAKE:
+		Intake();
+		break;
+
+	case AUTO_TOKEN_INTAKESTOP:
+		Message.command = COMMAND_ARM_INTAKE_STOP;
+		CommandNoResponse(ARM_QUEUE);
+		break;
+
+	case AUTO_TOKEN_RIDE:
+		Ride();
+		break;
+
+	case AUTO_TOKEN_AFTERSHOOT:
+		Message.command = COMMAND_ARM_MOVE_AFTERSHOOT;
+		CommandNoResponse(ARM_QUEUE);
+		break;
+
+	case AUTO_TOKEN_LOWERINTAKE:
+		Message.command = COMMAND_AUTONOMOUS_MOVEINTAKE;
+		CommandNoResponse(ARM_QUEUE);
+		break;
+
+	case AUTO_TOKEN_THROWUP:
+		Throwup();
+		break;
+
+	case AUTO_TOKEN_SHOOT:
+		printf("shooting\n");
+		Shoot();
+		break;
+
+	case AUTO_TOKEN_SETANGLE:
+		SetAngle();
+		break;
+
+	case AUTO_TOKEN_LOWER:
+		Lower();
+		break;
+
+	case AUTO_TOKEN_RAISE:
+		Raise();
+		break;
+
+	case AUTO_TOKEN_TAILDOWN:
+		TailDown();
+		break;
+
+	case AUTO_TOKEN_TAILUP:
+		TailUp();
+		break;
+
+	case AUTO_TOKEN_REDSENSE:
+		RedSense();
+		break;
+
+	case AUTO_TOKEN_START_DRIVE_FWD:
+	case AUTO_TOKEN_START_DRIVE_BCK:
+		//Get speed, it simply drives forward or back
+		if(instruction.iParams < 1)
+		{
+			SmartDashboard::PutString("Auto Status","EARLY DEATH!");
+			PRINTAUTOERROR;
+		}
+		else
+		{
+			SetCommand<COMMAND_DRIVETRAIN_STRAIGHT>(Message).driveSpeed = instruction.fParams[0];
+			CommandNoResponse(DRIVETRAIN_QUEUE);
+		}
+		break;
+
+	case AUTO_TOKEN_STOP_DRIVE:
+		Message.command = COMMAND_DRIVETRAIN_STOP;
+		CommandNoResponse(DRIVETRAIN_QUEUE);
+		break;
+
+	case AUTO_TOKEN_SHORT:
+		Short();
+		break;
+
+	case AUTO_TOKEN_JAWOPEN:
+		Message.command = COMMAND_SHOOTER_JAW_OPEN;
+		CommandNoResponse(SHOOTER_QUEUE);
+		break;
+
+	case AUTO_TOKEN_JAWCLOSE:
+		Message.command = COMMAND_SHOOTER_JAW_CLOSE;
+		CommandNoResponse(SHOOTER_QUEUE);
+		break;
+
+	default:
+		break;
+	}
+
+	if(bReturn)
+	{
+		printf("%0.3lf %s\n", pDebugTimer->Get(), instruction.szLine);
+	}
+
+	SmartDashboard::PutBoolean("bReturn", bReturn);
+	return (bReturn);
 }
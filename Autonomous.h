@@ -8,19 +8,51 @@
 //Robot
 #include <ComponentBase.h> //For the ComponentBase class
 #include <RobotParams.h> //For various robot parameters
+#include <PendingResponses.h> //For matching command responses
+#include <AutoParser.h> //For the compiled script
 #include <string>
+#include <sys/stat.h>
 
 #include "WPILib.h"
 
+class ShooterSequence;
 
-// if you have more than this many lines in your script, THEY WILL NOT RUN! Change if needed.
-const int AUTONOMOUS_SCRIPT_LINES = 150;
+
+// the whole script, its text and the program compiled from it, must fit in this many bytes.
+// A script that does not fit is not loaded at all.  Change if needed.
+const unsigned AUTONOMOUS_SCRIPT_BUDGET = 64 * 1024;
 const int AUTONOMOUS_CHECKLIST_LINES = 150;
-const char* const AUTONOMOUS_SCRIPT_FILEPATH = "/home/lvuser/RhsScript.txt";
+const char* const AUTONOMOUS_SCRIPT_FILEPATH = ROBOT_HOME_DIR "RhsScript.txt";
+
+///one loaded script in one block of memory: the text, then the program compiled from it
+struct AutoScript {
+	char *pArena;				//!< the text starts here, a line per string
+	unsigned uArenaSize;		//!< bytes allocated, kept for the next load to reuse
+	AutoInstruction *program;	//!< behind the text, comments and empty lines left out
+	int iProgramLength;
+};
 
-//from 2014
-const float MAX_VELOCITY_PARAM = 1.0;
-const float MAX_DISTANCE_PARAM = 100.0;
+///one command of a MultiCommandResponse, the results are filled in as it finishes
+struct CommandBranch {
+	const char *szQueueName;
+	RobotMessage message;
+	float fTimeout;					//!< seconds this command may take
+	MessageCommand response;		//!< COMMAND_UNKNOWN if it never answered
+	float fElapsed;					//!< seconds from sending to the answer
+	bool bTimedOut;
+	bool bNoResponse;				//!< sent in its turn with the others, nothing to wait for
+
+	CommandBranch(const char *szQueue, MessageCommand command, float fBranchTimeout = AUTONOMOUS_RESPONSE_TIMEOUT)
+	{
+		szQueueName = szQueue;
+		message.command = command;
+		fTimeout = fBranchTimeout;
+		response = COMMAND_UNKNOWN;
+		fElapsed = 0.0;
+		bTimedOut = false;
+		bNoResponse = false;
+	}
+};
 
 class Autonomous : public ComponentBase
 {
@@ -37,38 +69,50 @@ public:
 
 	static void *StartScript(void *pThis)
 	{
+		ThreadConfig::Apply(AUTOEXEC_TASKNAME, AUTOEXEC_PRIORITY);
 		((Autonomous *)pThis)->DoScript();
 		return(NULL);
 	}
 
 protected:
-	bool Evaluate(std::string statement);	//Evaluates an autonomous script statement
+	bool Evaluate(std::string statement);	//Compiles and executes one script statement
+	bool Execute(const AutoInstruction &instruction);	//Executes one compiled statement
 	RobotMessage Message;
-	bool bScriptLoaded; //not yet in use
+	bool bScriptLoaded;		//the file was there and loaded the last time it changed
 	bool bInAutoMode;
 	bool bPauseAutoMode;
 
 private:
-	std::string script[AUTONOMOUS_SCRIPT_LINES];	//Autonomous script
+	AutoScript scripts[2];	//one is running, the other is loaded into while disabled
+	AutoScript *pRunning;	//only touched while a script runs
+	AutoScript *pLoaded;	//the newest version of the file, compiled
+	bool bNewScript;		//pLoaded holds a good script that has not run yet
+	bool bRunningLoaded;	//pRunning holds a good script, it runs until one replaces it
+	struct stat scriptStat;	//the file as it was when pLoaded was read
+	unsigned uScriptLoads;
 	int lineNumber;
 	int iAutoDebugMode;
 	Task *pScript;
-	bool bReceivedCommandResponse;
-	unsigned int uResponseCount;
+	PendingResponses responses;
 	MessageCommand ReceivedCommand;
 	Timer *pDebugTimer;
+	ShooterSequence *pShooterSequence;	//SHOOT and SHORT run it in the script's task, made once
+	vector<CommandBranch> parallel;	//commands of the open PARALLEL block, sent at its JOIN
+	bool bInParallel;
 
 	void Delay(float);
 	bool Start();
 	bool Finish();
-	bool Begin(char *);
-	bool End(char *);
-	bool Move(char *);
+	bool Begin();
+	bool End();
+	bool Parallel();
+	bool Join(const AutoInstruction &);
+	bool Move(const AutoInstruction &);
 	bool Stop(char *);
-	bool MeasuredMove(char *);
-	bool MeasuredMoveToLine(char *);
-	bool Turn(char *);
-	bool Straight(char *);
+	bool MeasuredMove(const AutoInstruction &);
+	bool MeasuredMoveToLine(const AutoInstruction &);
+	bool Turn(const AutoInstruction &);
+	bool Straight(const AutoInstruction &);
 	bool Search();
 	bool Intake();
 	bool Ride();
@@ -84,14 +128,16 @@ private:
 	bool SetAngle();
 
 
-	bool CommandResponse(const char *szQueueName);
+	bool CommandResponse(const char *szQueueName, float fTimeout = AUTONOMOUS_RESPONSE_TIMEOUT);
 	bool CommandNoResponse(const char *szQueueName);
-	bool MultiCommandResponse(vector<char*> szQueueNames, vector<MessageCommand> commands);
+	bool MultiCommandResponse(vector<CommandBranch> &branches, bool bAny = false);
 
 	void Init();
 	void OnStateChange();
 	void Run();
-	bool LoadScriptFile();
+	bool WatchScriptFile();
+	bool LoadScriptFile(AutoScript &target);
+	void Compile(AutoScript &target);
 };
 
 #endif //AUTONOMOUS_BASE_H
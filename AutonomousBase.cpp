@@ -5,8 +5,14 @@
 #include <Autonomous.h>
 #include <ComponentBase.h>
 #include <RobotParams.h>
+#include <RobotClock.h>
+#include <ShooterSequence.h>
 #include "WPILib.h"
 //Local
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -15,17 +21,36 @@
 using namespace std;
 
 Autonomous::Autonomous()
-: ComponentBase(AUTONOMOUS_TASKNAME, AUTONOMOUS_QUEUE, AUTONOMOUS_PRIORITY)
+: ComponentBase(AUTONOMOUS_TASKNAME, AUTONOMOUS_QUEUE, AUTONOMOUS_PRIORITY, AUTONOMOUS_TICK_PERIOD)
 {
 	lineNumber = 0;
+	for(AutoScript &empty : scripts)
+	{
+		empty.pArena = NULL;
+		empty.uArenaSize = 0;
+		empty.program = NULL;
+		empty.iProgramLength = 0;
+	}
+
+	pRunning = &scripts[0];
+	pLoaded = &scripts[1];
+	bNewScript = false;
+	bScriptLoaded = false;
+	bRunningLoaded = false;
+	memset(&scriptStat, 0, sizeof(scriptStat));
+	uScriptLoads = 0;
+	bInParallel = false;
 	bInAutoMode = false;
 	iAutoDebugMode = 0;
-	bReceivedCommandResponse = false;
 	ReceivedCommand = COMMAND_UNKNOWN;
 
 	pDebugTimer = new Timer();
 	pDebugTimer->Start();
 
+	// one for good, every sequence holds a robot state subscription while it lives
+
+	pShooterSequence = new ShooterSequence();
+
 	pTask = new Task(AUTONOMOUS_TASKNAME, &Autonomous::StartTask, this);
 	wpi_assert(pTask);
 
@@ -37,6 +62,9 @@ Autonomous::~Autonomous()	//Destructor
 {
 	delete(pTask);
 	delete(pScript);
+	delete(pShooterSequence);
+	delete[] scripts[0].pArena;
+	delete[] scripts[1].pArena;
 }
 
 void Autonomous::Init()	//Initializes the autonomous component
@@ -75,15 +103,14 @@ void Autonomous::Run()
 			break;
 
 		case COMMAND_AUTONOMOUS_RESPONSE_OK:
-			uResponseCount++;
-			bReceivedCommandResponse = true;
-			ReceivedCommand = COMMAND_AUTONOMOUS_RESPONSE_OK;
-			break;
-
 		case COMMAND_AUTONOMOUS_RESPONSE_ERROR:
-			uResponseCount++;
-			bReceivedCommandResponse = true;
-			ReceivedCommand = COMMAND_AUTONOMOUS_RESPONSE_ERROR;
+			// wakes up the script if it is still waiting for this one
+
+			if(!responses.Complete(&localMessage))
+			{
+				printf("%0.3lf late response %s dropped\n", pDebugTimer->Get(),
+						GetCommandName(localMessage.command));
+			}
 			break;
 
 		default:
@@ -91,43 +118,155 @@ void Autonomous::Run()
 	}
 }
 
-bool Autonomous::LoadScriptFile()
+bool Autonomous::WatchScriptFile()
 {
-	bool bReturn = true;
-	//printf("Auto Script Filepath: [%s]\n", AUTONOMOUS_SCRIPT_FILEPATH);
-	ifstream scriptStream;
-	scriptStream.open(AUTONOMOUS_SCRIPT_FILEPATH);
-	
-	if(scriptStream.is_open())//not working
+	struct stat fileStat;
+	AutoCheck check;
+
+	// a stat() is all it costs while the file stays the same
+
+	// a file that went missing or would not load leaves the last good script
+	// running, a bad edit in the pits must not turn autonomous off
+
+	if(stat(AUTONOMOUS_SCRIPT_FILEPATH, &fileStat) != 0)
 	{
-		for(int i = 0; i < AUTONOMOUS_SCRIPT_LINES; ++i)
-		{
-			if(!scriptStream.eof())
-			{
-				getline(scriptStream, script[i]);
-				//cout << script[i] << endl;
-			}
-			else
-			{
-				script[i].clear();
-			}
-		}
+		memset(&scriptStat, 0, sizeof(scriptStat));
+		bScriptLoaded = false;
+		return(bNewScript || bRunningLoaded);
+	}
 
-		//printf("Autonomous script loaded\n");
-		scriptStream.close();
-	}	
-	else
+	if((fileStat.st_mtim.tv_sec == scriptStat.st_mtim.tv_sec) &&
+			(fileStat.st_mtim.tv_nsec == scriptStat.st_mtim.tv_nsec) &&
+			(fileStat.st_size == scriptStat.st_size) && (fileStat.st_ino == scriptStat.st_ino))
+	{
+		return(bNewScript || bRunningLoaded);
+	}
+
+	// new or changed, read it into the buffer that is not running.  If it is
+	// written again while we read, the next stat() sees that and reads it again.
+	// One that would not load is not tried again until it changes
+
+	scriptStat = fileStat;
+	bScriptLoaded = LoadScriptFile(*pLoaded);
+
+	if(!bScriptLoaded)
+	{
+		// whatever was waiting in pLoaded has been read over
+
+		bNewScript = false;
+		printf("%0.3lf autonomous script did not load, %s\n", pDebugTimer->Get(),
+				bRunningLoaded ? "keeping the one that ran last" : "nothing to run");
+		return(bRunningLoaded);
+	}
+
+	bNewScript = true;
+	uScriptLoads++;
+	printf("%0.3lf autonomous script loaded (%u), %d instructions\n", pDebugTimer->Get(),
+			uScriptLoads, pLoaded->iProgramLength);
+
+	// a script with mistakes still runs, the lines without them may be all we have
+
+	check = AutoValidate(pLoaded->program, pLoaded->iProgramLength, AUTONOMOUS_SCRIPT_FILEPATH, stdout);
+	SmartDashboard::PutNumber("Script Errors", check.iErrors);
+	SmartDashboard::PutNumber("Script Warnings", check.iWarnings);
+	SmartDashboard::PutNumber("Script Worst Case", check.fWorstCase);
+	return(true);
+}
+
+///makes the arena at least uSize bytes, keeping the first uKeep bytes of what is there
+static void ReserveScript(AutoScript &target, unsigned uSize, unsigned uKeep)
+{
+	char *pArena;
+
+	if(uSize <= target.uArenaSize)
+	{
+		return;
+	}
+
+	pArena = new char[uSize];
+	memcpy(pArena, target.pArena, uKeep);
+	delete[] target.pArena;
+	target.pArena = pArena;
+	target.uArenaSize = uSize;
+}
+
+bool Autonomous::LoadScriptFile(AutoScript &target)
+{
+	ifstream scriptStream;
+	long long llFileSize;
+	unsigned uTextSize;
+	unsigned uProgramStart;
+	unsigned uLines;
+	unsigned uNeeded;
+
+	//printf("Auto Script Filepath: [%s]\n", AUTONOMOUS_SCRIPT_FILEPATH);
+	scriptStream.open(AUTONOMOUS_SCRIPT_FILEPATH, ios::in | ios::binary);
+
+	if(!scriptStream.is_open())
 	{
 		//printf("No auto file found\n");
-		bReturn = false;
+		return(false);
+	}
+
+	scriptStream.seekg(0, ios::end);
+	llFileSize = scriptStream.tellg();
+	scriptStream.seekg(0, ios::beg);
+
+	if((llFileSize < 0) || (llFileSize >= AUTONOMOUS_SCRIPT_BUDGET))
+	{
+		printf("%0.3lf autonomous script is %lld bytes, AUTONOMOUS_SCRIPT_BUDGET is %u, not loaded\n",
+				pDebugTimer->Get(), llFileSize, AUTONOMOUS_SCRIPT_BUDGET);
+		return(false);
+	}
+
+	// the text goes in first, the program can only be laid out behind it once
+	// we know how many lines there are.  The arena only ever grows
+
+	ReserveScript(target, llFileSize + 1, 0);
+	scriptStream.read(target.pArena, llFileSize);
+	uTextSize = scriptStream.gcount();
+	target.pArena[uTextSize] = '\0';
+	scriptStream.close();
+
+	uLines = std::count(target.pArena, target.pArena + uTextSize, '\n') + 1;
+	uProgramStart = (uTextSize + alignof(AutoInstruction)) & ~(alignof(AutoInstruction) - 1);
+	uNeeded = uProgramStart + uLines * sizeof(AutoInstruction);
+
+	if(uNeeded > AUTONOMOUS_SCRIPT_BUDGET)
+	{
+		printf("%0.3lf autonomous script needs %u bytes, AUTONOMOUS_SCRIPT_BUDGET is %u, not loaded\n",
+				pDebugTimer->Get(), uNeeded, AUTONOMOUS_SCRIPT_BUDGET);
+		return(false);
 	}
 
-	return(bReturn);
+	ReserveScript(target, uNeeded, uTextSize + 1);
+	target.program = (AutoInstruction *)(target.pArena + uProgramStart);
+	Compile(target);
+	//printf("Autonomous script loaded\n");
+	return(true);
+}
+
+void Autonomous::Compile(AutoScript &target)
+{
+	// decode every line now, while disabled, so running the script is only a dispatch
+
+	target.iProgramLength = AutoCompileText(target.pArena, target.program);
 }
 
 void Autonomous::DoScript()
 {
 	//int loadAttemptTally = 0; //for debugging
+	unsigned uStartLookups;
+	unsigned uStartOpens;
+	unsigned uEndLookups;
+	unsigned uEndOpens;
+	struct timespec cpuStart;
+	struct timespec cpuEnd;
+	double dWallStart;
+	double dCpuPercent;
+	bool bRan;
+	int iInstruction;
+
 	SmartDashboard::PutString("Script Line", "DoScript started");
 	SmartDashboard::PutString("Auto Status", "Ready to go");
 	SmartDashboard::PutBoolean("Script File Loaded", false);
@@ -138,9 +277,9 @@ void Autonomous::DoScript()
 		lineNumber = 0;
 		SmartDashboard::PutNumber("Script Line Number", lineNumber);
 
-		//TODO: LoadScriptFile is called every stinking time we want to check load status! Does this eat time?
-		//We want to load the file while disabled - this allows us to load new scripts
-		if(LoadScriptFile() == false)
+		//We want to load the file while disabled - this allows us to load new scripts.  It is
+		//only read when it changes, and never into the copy a script is running from
+		if(WatchScriptFile() == false)
 		{
 			// wait a little and try again, really only useful if when practicing
 
@@ -149,44 +288,95 @@ void Autonomous::DoScript()
 		}
 		else
 		{
-			SmartDashboard::PutBoolean("Script File Loaded", true);
+			// false while a bad edit waits to be fixed, the last good script still runs
+
+			SmartDashboard::PutBoolean("Script File Loaded", bScriptLoaded);
+
+			// read the flag once, tAuto may set it at any moment.  The newest script
+			// takes over only as autonomous starts, never part way through one
+
+			bRan = bInAutoMode;
+
+			if(bRan && bNewScript)
+			{
+				std::swap(pRunning, pLoaded);
+				bNewScript = false;
+				bRunningLoaded = true;
+			}
 
 			// if there is a script we will execute it some heck or high water!
 
-			while (bInAutoMode)
+			MessageQueue::GetEndpointStats(uStartLookups, uStartOpens);
+			clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuStart);
+			dWallStart = pDebugTimer->Get();
+
+			iInstruction = 0;
+			bInParallel = false;
+
+			while (bRan && bInAutoMode)
 			{
 				SmartDashboard::PutNumber("Script Line Number", lineNumber);
 
 				if (!bPauseAutoMode)
 				{
-					if (lineNumber < AUTONOMOUS_SCRIPT_LINES)
+					if (iInstruction < pRunning->iProgramLength)
 					{
-						// can we have empty lines?  at the end I guess
-
-						if (script[lineNumber].empty() == false)
-						{
-							// handle pausing in the Evaluate method
+						// empty lines and comments were left out by Compile()
+						// handle pausing in the Execute method
 
-							SmartDashboard::PutString("Script Line",
-									script[lineNumber].c_str());
+						lineNumber = pRunning->program[iInstruction].iLine;
+						SmartDashboard::PutString("Script Line", pRunning->program[iInstruction].szLine);
 
-							if (Evaluate(script[lineNumber]))
-							{
-								SmartDashboard::PutString("Script Line", "<NOT RUNNING>");
-								break;
-							}
+						if (Execute(pRunning->program[iInstruction]))
+						{
+							SmartDashboard::PutString("Script Line", "<NOT RUNNING>");
+							break;
 						}
 
-						lineNumber++;
+						iInstruction++;
 					}
 					else
 					{
 						break;
 					}
 				}
+				else
+				{
+					// paused part way through, sleep like Execute() does or we spin at FIFO
+					Wait(0.02);
+				}
+			}
+
+			// how many queue opens did the endpoint cache save us?
+
+			MessageQueue::GetEndpointStats(uEndLookups, uEndOpens);
+
+			if(uEndLookups != uStartLookups)
+			{
+				printf("%0.3lf endpoint cache: %u sends, %u opens, %u opens saved\n",
+						pDebugTimer->Get(), uEndLookups - uStartLookups, uEndOpens - uStartOpens,
+						(uEndLookups - uStartLookups) - (uEndOpens - uStartOpens));
+			}
+
+			// how much of a CPU did the script use, waiting on responses included?
+
+			clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuEnd);
+
+			if(bRan && (pDebugTimer->Get() > dWallStart))
+			{
+				dCpuPercent = 100.0 * ((cpuEnd.tv_sec - cpuStart.tv_sec) +
+						(cpuEnd.tv_nsec - cpuStart.tv_nsec) / 1.0e9) /
+						(RobotClock::RealUs((long long)((pDebugTimer->Get() - dWallStart) * 1000000.0)) / 1.0e6);
+				SmartDashboard::PutNumber("Auto Script CPU %", dCpuPercent);
+				printf("%0.3lf script cpu: %0.1lf%%, %u responses still pending, %u dropped\n",
+						pDebugTimer->Get(), dCpuPercent, responses.GetPending(), responses.GetUnmatched());
+			}
+
+			if(bRan)
+			{
+				bInAutoMode = false;
 			}
 
-			bInAutoMode = false;
 			Wait(0.1);
 		}
 	}
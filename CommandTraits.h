@@ -0,0 +1,133 @@
+/** \file
+ *  Compile time description of which parameters go with which command.
+ *
+ * Every command that carries data is tied to one member of MessageParams
+ * here.  Use GetParams<COMMAND_x>() instead of reaching into the union.  The
+ * parameters come back as the type that goes with COMMAND_x, and asking for a
+ * command that has no parameters will not compile.  Whether the message really
+ * carries COMMAND_x is only known at run time, an assert checks it, and like
+ * any assert it is gone when NDEBUG is defined.  SetCommand<COMMAND_x>() fills
+ * in the command and hands back the right parameters to fill in, so nothing
+ * can get that one wrong.
+ *
+ * The same table gives the size of each command's parameters, so the
+ * mailboxes only copy as much of the union as the command actually uses.
+ */
+
+#ifndef COMMAND_TRAITS_H
+#define COMMAND_TRAITS_H
+
+#include <assert.h>
+#include <string.h>
+
+//Robot
+#include <RobotMessage.h>
+
+///never defined, commands without parameters use it so asking for them fails
+struct NoParams;
+
+///by default a command carries nothing
+template<MessageCommand C> struct CommandTraits
+{
+	typedef NoParams Params;
+	static const unsigned uParamsSize = 0;
+};
+
+///ties a command to the MessageParams member it uses
+#define COMMAND_PARAMS(command, type, member) \
+	template<> struct CommandTraits<command> \
+	{ \
+		typedef type Params; \
+		static const unsigned uParamsSize = sizeof(type); \
+		static type &Get(MessageParams &params) { return(params.member); }; \
+		static const type &Get(const MessageParams &params) { return(params.member); }; \
+	};
+
+COMMAND_PARAMS(COMMAND_SYSTEM_CONSTANTS,				SystemParams,			system)
+COMMAND_PARAMS(COMMAND_AUTONOMOUS_SEARCHGOAL,		ArmParams,				armParams)
+COMMAND_PARAMS(COMMAND_DRIVETRAIN_DRIVE_TANK,		TankDriveParams,		tankDrive)
+COMMAND_PARAMS(COMMAND_DRIVETRAIN_AUTO_MOVE,			TankDriveParams,		tankDrive)
+COMMAND_PARAMS(COMMAND_DRIVETRAIN_STRAIGHT,			AutonomousParams,		autonomous)
+COMMAND_PARAMS(COMMAND_DRIVETRAIN_MSTRAIGHT,			AutonomousParams,		autonomous)
+COMMAND_PARAMS(COMMAND_DRIVETRAIN_MLINE,				AutonomousParams,		autonomous)
+COMMAND_PARAMS(COMMAND_DRIVETRAIN_TURN,				AutonomousParams,		autonomous)
+COMMAND_PARAMS(COMMAND_DRIVETRAIN_DRIVE_SPLITARCADE,	SplitArcadeDriveParams,	splitArcadeDrive)
+COMMAND_PARAMS(COMMAND_DRIVETRAIN_DRIVE_CHEEZY,		CheezyDriveParams,		cheezyDrive)
+COMMAND_PARAMS(COMMAND_ARM_INTAKE,					ArmParams,				armParams)
+
+#undef COMMAND_PARAMS
+
+///the parameters of a message that must be carrying command C, asserted, so only checked without NDEBUG
+template<MessageCommand C>
+typename CommandTraits<C>::Params &GetParams(RobotMessage &message)
+{
+	static_assert(CommandTraits<C>::uParamsSize > 0, "this command has no parameters");
+	assert(message.command == C);
+	return(CommandTraits<C>::Get(message.params));
+}
+
+template<MessageCommand C>
+const typename CommandTraits<C>::Params &GetParams(const RobotMessage &message)
+{
+	static_assert(CommandTraits<C>::uParamsSize > 0, "this command has no parameters");
+	assert(message.command == C);
+	return(CommandTraits<C>::Get(message.params));
+}
+
+///sets the command and returns its parameters to fill in
+template<MessageCommand C>
+typename CommandTraits<C>::Params &SetCommand(RobotMessage &message)
+{
+	static_assert(CommandTraits<C>::uParamsSize > 0, "this command has no parameters, just set message.command");
+	message.command = C;
+	return(CommandTraits<C>::Get(message.params));
+}
+
+// build a table of parameter sizes indexed by command, one entry per
+// CommandTraits, so there is no second list to keep up to date
+
+template<unsigned... I> struct CommandSequence {};
+
+template<unsigned N, unsigned... I> struct MakeCommandSequence : MakeCommandSequence<N - 1, N - 1, I...> {};
+
+template<unsigned... I> struct MakeCommandSequence<0, I...>
+{
+	typedef CommandSequence<I...> type;
+};
+
+template<typename S> struct ParamsSizeTable;
+
+template<unsigned... I> struct ParamsSizeTable<CommandSequence<I...> >
+{
+	static constexpr unsigned char uSizes[sizeof...(I)] = { CommandTraits<(MessageCommand)I>::uParamsSize... };
+};
+
+template<unsigned... I>
+constexpr unsigned char ParamsSizeTable<CommandSequence<I...> >::uSizes[sizeof...(I)];
+
+typedef ParamsSizeTable<MakeCommandSequence<COMMAND_LAST>::type> CommandParamsSizes;
+
+///bytes of MessageParams a command actually uses
+inline unsigned GetParamsSize(MessageCommand command)
+{
+	// an out of range command gets the whole union, better safe than sorry
+
+	if((unsigned)command >= (unsigned)COMMAND_LAST)
+	{
+		return(sizeof(MessageParams));
+	}
+
+	return(CommandParamsSizes::uSizes[command]);
+}
+
+///copies a message, but only the part of the parameters the command uses
+inline void CopyMessage(RobotMessage *pTo, const RobotMessage *pFrom)
+{
+	pTo->command = pFrom->command;
+	pTo->replyQ = pFrom->replyQ;
+	pTo->uCorrelation = pFrom->uCorrelation;
+	pTo->trace = pFrom->trace;
+	memcpy(&pTo->params, &pFrom->params, GetParamsSize(pFrom->command));
+}
+
+#endif //COMMAND_TRAITS_H
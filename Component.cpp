@@ -16,7 +16,7 @@
 //Robot
 
 Component::Component()
-: ComponentBase(COMPONENT_TASKNAME, COMPONENT_QUEUE, COMPONENT_PRIORITY)
+: ComponentBase(COMPONENT_TASKNAME, COMPONENT_QUEUE, COMPONENT_PRIORITY, COMPONENT_TICK_PERIOD)
 {
 	//TODO: add member objects
 	pTask = new Task(COMPONENT_TASKNAME, (FUNCPTR) &Component::StartTask,
@@ -9,118 +9,413 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <assert.h>
-#include <ComponentBase.h>
 #include <errno.h>
-#include <fcntl.h>
-#include <sys/select.h>
-#include <sys/types.h>
+#include <string.h>
+#include <time.h>
+#include <ComponentBase.h>
 
 //Local
 
 //Robot
 class RhsRobot;
 #include <RobotMessage.h>
+#include <RobotParams.h>
+
+std::atomic<unsigned> ComponentBase::uNextTraceSource(1);
+bool ComponentBase::bExecutorMode = false;
 
-ComponentBase::ComponentBase(const char* componentName, const char *queueName, int priority)
+ComponentBase::ComponentBase(const char* componentName, const char *queueName, int priority, float fTickPeriod)
 {	
 	iLoop = 0;
-	iPipeRcv = -1;
-	iPipeXmt = -1;
 	pTask = NULL;
+	this->componentName = componentName;
+	iPriority = priority;
+	this->fTickPeriod = fTickPeriod;
+	pTickTimer = (fTickPeriod > 0.0) ? new PeriodicTimer(fTickPeriod) : NULL;
+	llLastMessageUs = 0;
+	llLastReportUs = 0;
+
+	llLastRunUs = 0;
+	uRunBudgetUs = (unsigned)(((fTickPeriod > 0.0) ? fTickPeriod : DEFAULT_RUN_BUDGET) * 1000000.0);
+	uBudgetOverruns = 0;
+	worstCommand = COMMAND_UNKNOWN;
+	llLastOverrunReportUs = 0;
+
+	uTraceSource = uNextTraceSource++;
+	bMatchRunning = false;
+	pQueueDelay = new Histogram[COMMAND_LAST];
+	pHandleTime = new Histogram[COMMAND_LAST];
 
-	mkfifo(queueName, 0666);
-	queueLocal = queueName;
+	pQueue = new MessageQueue(queueName);
+	pQueue->SetOverflow(MESSAGE_LANE_NORMAL, QUEUE_OVERFLOW);
+	pQueue->SetOverflow(MESSAGE_LANE_HIGH, QUEUE_HIGH_OVERFLOW);
+
+	for(unsigned i = 0; i < sizeof(QUEUE_PARAMS) / sizeof(QUEUE_PARAMS[0]); ++i)
+	{
+		if(strcmp(QUEUE_PARAMS[i].szQueueName, queueName) == 0)
+		{
+			pQueue->SetOverflow(MESSAGE_LANE_NORMAL, QUEUE_PARAMS[i].iOverflow);
+			pQueue->SetOverflow(MESSAGE_LANE_HIGH, QUEUE_PARAMS[i].iHighOverflow);
+		}
+	}
+	uBatchCount = 0;
+	uBatchNext = 0;
+
+	// every component needs to hear about state changes
+
+	Subscribe(MESSAGE_TOPIC_ROBOT_STATE);
+	Subscribe(MESSAGE_TOPIC_DIAGNOSTICS);
+}
+
+ComponentBase::~ComponentBase()
+{
+	for(int i = 0; i < MESSAGE_TOPIC_LAST; ++i)
+	{
+		MessageBus::Unsubscribe(i, pQueue);
+	}
+
+	delete pQueue;
+	delete pTickTimer;
+	delete[] pQueueDelay;
+	delete[] pHandleTime;
+}
+
+void ComponentBase::Subscribe(int iTopic)
+{
+	MessageBus::Subscribe(iTopic, pQueue);
 }
 
 void ComponentBase::SendMessage(RobotMessage* robotMessage)
 {
-	RobotMessage message = *robotMessage;
+	pQueue->Send(robotMessage);
+}
+
+void ComponentBase::HandleBatch()			//Hands each message in the batch to HandleMessage() in order
+{
+	// uBatchNext moves before the handler runs so ClearMessages() can cut the batch short
 
-	if(iPipeXmt < 0)
+	for(uBatchNext = 0; uBatchNext < uBatchCount; )
 	{
-		iPipeXmt = open(queueLocal.c_str(), O_WRONLY);
-		//fcntl(iPipeXmt, F_SETFL, fcntl(iPipeXmt, F_GETFL) | O_NONBLOCK);
-		assert(iPipeXmt > 0);
+		CopyMessage(&localMessage, &batch[uBatchNext++]);
+		HandleMessage();
 	}
+}
+
+void ComponentBase::ClearMessages(void)
+{
+	// eat all the messages in the queue, and what is left of this batch
 
-	write(iPipeXmt, (char*)&message, sizeof(RobotMessage));
+	pQueue->Clear();
+	uBatchNext = uBatchCount;
+
+	// make sure the localMessage is innocuous
+	
+	localMessage.command = COMMAND_SYSTEM_MSGTIMEOUT;
 }
 
-void ComponentBase::ReceiveMessage()			//Receives a message and copies it into localMessage
+const char* ComponentBase::GetComponentName()
 {
-	fd_set selectSet;
-	struct timeval timeout;
+	return(componentName);
+}
+
+void ComponentBase::ReportMessage()
+{
+	static const char * const szLaneNames[MESSAGE_LANE_LAST] = { "high", "normal" };
+	long long llNowUs = PeriodicTimer::NowUs();
+	MessageLaneStats stats;
+	string prefix;
+
+	// the dashboard does not need these every loop
+
+	if(llNowUs - llLastReportUs < (long long)(fUpdateDelay * 1000000.0))
+	{
+		return;
+	}
+
+	llLastReportUs = llNowUs;
 
-	if(iPipeRcv < 0)
+	for(int i = 0; i < MESSAGE_LANE_LAST; ++i)
 	{
-		iPipeRcv = open(queueLocal.c_str(), O_RDONLY);
-		assert(iPipeRcv > 0);
+		pQueue->GetLaneStats(i, stats);
+		prefix = string(componentName) + " " + szLaneNames[i] + " ";
+
+		SmartDashboard::PutNumber(prefix + "depth", stats.uDepth);
+		SmartDashboard::PutNumber(prefix + "high water", stats.uHighWater);
+		SmartDashboard::PutNumber(prefix + "wait avg us", stats.fWaitAvgUs);
+		SmartDashboard::PutNumber(prefix + "wait max us", stats.uWaitMaxUs);
+		SmartDashboard::PutNumber(prefix + "full", stats.uOverflows);
+		SmartDashboard::PutNumber(prefix + "dropped", stats.uDropped);
 	}
 
-	FD_ZERO(&selectSet);
-	FD_SET(iPipeRcv, &selectSet);
+	SmartDashboard::PutNumber(string(componentName) + " folded", pQueue->GetFolded());
+
+	prefix = string(componentName) + " run ";
 
-	timeout.tv_sec = 0;
-	timeout.tv_usec = 40000;
+	SmartDashboard::PutNumber(prefix + "avg us", runTime.GetMean());
+	SmartDashboard::PutNumber(prefix + "p99 us", runTime.GetPercentile(99.0));
+	SmartDashboard::PutNumber(prefix + "max us", runTime.GetMax());
+	SmartDashboard::PutNumber(prefix + "interval p99 us", loopInterval.GetPercentile(99.0));
+	SmartDashboard::PutNumber(prefix + "overruns", uBudgetOverruns);
+	SmartDashboard::PutString(prefix + "worst", GetCommandName(worstCommand));
 
-	if(select(iPipeRcv + 1, &selectSet, NULL, NULL, &timeout) == 0)
+	if(pTickTimer && !bExecutorMode)
 	{
-		localMessage.command = COMMAND_SYSTEM_MSGTIMEOUT;
+		prefix = string(componentName) + " tick ";
+
+		SmartDashboard::PutNumber(prefix + "overruns", pTickTimer->GetOverruns());
+		SmartDashboard::PutNumber(prefix + "jitter avg us", pTickTimer->GetJitterAvg());
+		SmartDashboard::PutNumber(prefix + "jitter max us", pTickTimer->GetJitterMax());
 	}
-	else
+}
+
+void ComponentBase::DumpTrace(const char *szReason, bool bClear)
+{
+	char szFileName[128];
+	FILE *pFile;
+
+	snprintf(szFileName, sizeof(szFileName), MESSAGE_TRACE_FILE, componentName);
+	pFile = fopen(szFileName, "a");
+
+	if(!pFile)
 	{
-		read(iPipeRcv, (char*)&localMessage, sizeof(RobotMessage));
+		printf("%s: unable to open %s\n", componentName, szFileName);
+		return;
 	}
+
+	fprintf(pFile, "=== %s message trace, %s, microseconds ===\n", componentName, szReason);
+	runTime.Print(pFile, "Run()");
+	loopInterval.Print(pFile, "between Run()");
+	fprintf(pFile, "%-32s %u over %u us, worst while handling %s\n", "budget",
+			uBudgetOverruns, uRunBudgetUs, GetCommandName(worstCommand));
+
+	for(int i = 0; i < COMMAND_LAST; ++i)
+	{
+		string label = GetCommandName((MessageCommand)i);
+
+		if(pQueueDelay[i].GetCount())
+		{
+			pQueueDelay[i].Print(pFile, (label + " queued").c_str());
+		}
+
+		if(pHandleTime[i].GetCount())
+		{
+			pHandleTime[i].Print(pFile, (label + " handled").c_str());
+		}
+
+		if(bClear)
+		{
+			pQueueDelay[i].Clear();
+			pHandleTime[i].Clear();
+		}
+	}
+
+	if(bClear)
+	{
+		runTime.Clear();
+		loopInterval.Clear();
+		uBudgetOverruns = 0;
+		worstCommand = COMMAND_UNKNOWN;
+	}
+
+	fclose(pFile);
 }
 
-void ComponentBase::ClearMessages(void)
+void ComponentBase::ProfileRun(long long llStartUs, long long llEndUs)
 {
-	RobotMessage eatMessage;
-	
-	// eat all the messages in the queue
-	
-	fcntl(iPipeRcv, F_SETFL, O_NONBLOCK);
+	unsigned uRunUs = (unsigned)(llEndUs - llStartUs);
 
-	while(read(iPipeRcv, (char*)&eatMessage, sizeof(RobotMessage)) > 0)
+	if(llLastRunUs)
 	{
-		// intentionally empty
+		loopInterval.Add((unsigned)(llStartUs - llLastRunUs));
 	}
 
-	fcntl(iPipeRcv, F_SETFL, 0);
+	llLastRunUs = llStartUs;
 
-	// make sure the localMessage is innocuous
-	
-	localMessage.command = COMMAND_SYSTEM_MSGTIMEOUT;
+	if(uRunUs > runTime.GetMax())
+	{
+		worstCommand = localMessage.command;
+	}
+
+	runTime.Add(uRunUs);
+
+	if(uRunBudgetUs && (uRunUs > uRunBudgetUs))
+	{
+		uBudgetOverruns++;
+
+		// a handler that blocks every loop would print every loop, once a second is plenty
+
+		if(llEndUs - llLastOverrunReportUs >= 1000000LL)
+		{
+			printf("%s: Run() took %u us handling %s, budget is %u us (%u overruns)\n",
+					componentName, uRunUs, GetCommandName(localMessage.command),
+					uRunBudgetUs, uBudgetOverruns);
+			llLastOverrunReportUs = llEndUs;
+		}
+	}
+}
+
+void ComponentBase::HandleMessage()
+{
+	bool bTracing = MessageQueue::IsTracing();
+	long long llStartUs;
+	long long llEndUs;
+
+	if(localMessage.command == COMMAND_SYSTEM_TRACE_DUMP)
+	{
+		DumpTrace("on request", false);
+		return;
+	}
+
+	llStartUs = MessageQueue::GetTraceTimeUs();
+
+	if(bTracing)
+	{
+		// timeouts are made up locally, and anything sent before tracing
+		// was turned on has no timestamp
+
+		if((localMessage.command != COMMAND_SYSTEM_MSGTIMEOUT) &&
+				(localMessage.trace.llSentUs > 0) && (localMessage.trace.llSentUs <= llStartUs))
+		{
+			pQueueDelay[localMessage.command].Add((unsigned)(llStartUs - localMessage.trace.llSentUs));
+		}
+	}
+
+	if(localMessage.command == COMMAND_ROBOT_STATE_DISABLED ||			//Tests for state change messages
+			localMessage.command == COMMAND_ROBOT_STATE_AUTONOMOUS ||
+			localMessage.command == COMMAND_ROBOT_STATE_TELEOPERATED ||
+			localMessage.command == COMMAND_ROBOT_STATE_TEST ||
+			localMessage.command == COMMAND_ROBOT_STATE_UNKNOWN)
+	{
+		OnStateChange();			//Handles state changes
+
+		if(localMessage.command == COMMAND_ROBOT_STATE_DISABLED)
+		{
+			if(bMatchRunning && bTracing)
+			{
+				DumpTrace("end of match", true);
+			}
+
+			bMatchRunning = false;
+		}
+		else if(localMessage.command == COMMAND_ROBOT_STATE_AUTONOMOUS ||
+				localMessage.command == COMMAND_ROBOT_STATE_TELEOPERATED)
+		{
+			bMatchRunning = true;
+		}
+	}
+
+	Run();			//Component logic
+
+	llEndUs = MessageQueue::GetTraceTimeUs();
+	ProfileRun(llStartUs, llEndUs);
+
+	if(bTracing)
+	{
+		pHandleTime[localMessage.command].Add((unsigned)(llEndUs - llStartUs));
+	}
+
+	lastCommand = localMessage.command;
+	iLoop++;
+
+	ReportMessage();
 }
 
 void ComponentBase::DoWork()
 {
+	if(bExecutorMode)
+	{
+		return;					//The executor calls Step() for us
+	}
+
+	// set our priority and CPU before doing any real work
+
+	ThreadConfig::Apply(componentName, iPriority);
+
+	// everything sent from this task is traced back to us
+
+	MessageQueue::SetTraceSource(uTraceSource);
+
+	if(fTickPeriod > 0.0)
+	{
+		DoTickedWork();			//Never returns
+	}
+
 	while(true)
 	{
-		ReceiveMessage();		//Receives a message and copies it into localMessage
+		// sleep until something arrives, then take everything that is waiting
+
+		uBatchCount = pQueue->ReceiveBatch(batch, MESSAGE_BATCH_SIZE, iMessageTimeoutUs);
 
-		if(localMessage.command == COMMAND_ROBOT_STATE_DISABLED ||			//Tests for state change messages
-				localMessage.command == COMMAND_ROBOT_STATE_AUTONOMOUS ||
-				localMessage.command == COMMAND_ROBOT_STATE_TELEOPERATED ||
-				localMessage.command == COMMAND_ROBOT_STATE_TEST ||
-				localMessage.command == COMMAND_ROBOT_STATE_UNKNOWN)
+		if(uBatchCount == 0)
 		{
-			OnStateChange();			//Handles state changes
+			localMessage.command = COMMAND_SYSTEM_MSGTIMEOUT;
+			HandleMessage();
 		}
+		else
+		{
+			HandleBatch();
+		}
+	}
+}
+
+void ComponentBase::Step()
+{
+	long long llNowUs = PeriodicTimer::NowUs();
+	bool bHandled = false;
+	bool bBatchFull;
+
+	// the executor steps everyone from one task, keep the traces honest
 
-		Run();			//Component logic
-		lastCommand = localMessage.command;
-		iLoop++;
+	MessageQueue::SetTraceSource(uTraceSource);
+
+	// drain everything that arrived since the last tick, a batch at a time,
+	// only going back for more when the last batch was full before folding
+
+	do
+	{
+		uBatchCount = pQueue->ReceiveBatch(batch, MESSAGE_BATCH_SIZE, 0, &bBatchFull);
+		HandleBatch();
+		bHandled |= (uBatchCount > 0);
+	} while(bBatchFull);
+
+	if(bHandled)
+	{
+		llLastMessageUs = llNowUs;
+		return;
+	}
+
+	// nothing new.  Ticked components run their logic anyway, message driven
+	// ones get the same timeout the threaded loop would have given them
+
+	if((fTickPeriod > 0.0) || (llNowUs - llLastMessageUs >= iMessageTimeoutUs))
+	{
+		localMessage.command = COMMAND_SYSTEM_MSGTIMEOUT;
+		HandleMessage();
+		llLastMessageUs = llNowUs;
 	}
 }
+
+void ComponentBase::DoTickedWork()
+{
+	pTickTimer->Start();
+
+	while(true)
+	{
+		pTickTimer->WaitForNextTick();
+		Step();
+	}
+}
+
 void ComponentBase::SendCommandResponse(MessageCommand command)
 {
 	RobotMessage replyMessage;
 		replyMessage.command = command;
+		replyMessage.replyQ = NULL;
+		//Tell the requester which of its requests this answers
+		replyMessage.uCorrelation = localMessage.uCorrelation;
 		//Send a message back to auto to tell it that code is done.
-		int iPipeXmt = open(localMessage.replyQ, O_WRONLY);
-		assert(iPipeXmt > 0);
+		MessageQueue *pReplyQueue = MessageQueue::GetEndpoint(localMessage.replyQ);
+		assert(pReplyQueue);
 
-		write(iPipeXmt, (char*) &replyMessage, sizeof(RobotMessage));
-		close(iPipeXmt);
+		pReplyQueue->Send(&replyMessage);
 }
@@ -14,8 +14,7 @@
 #include <sys/stat.h>        /* For mode constants */
 #include <time.h>			 /* for timeout structure */
 #include <errno.h>
-#include <mqueue.h>		     /* for POSIX message queues */
-#include <unistd.h>			/* for pipes */
+#include <unistd.h>
 
 #include <string>
 #include <iostream>
@@ -25,19 +24,37 @@ using namespace std;
 
 //Robot
 #include <RobotMessage.h>			//For the RobotMessage struct
+#include <MessageQueue.h>			//For the in-process mailbox
+#include <MessageBus.h>				//For broadcast topics
+#include <Histogram.h>				//For message trace statistics
+#include <ThreadConfig.h>			//For thread priorities and placement
+#include <PeriodicTimer.h>			//For the fixed rate tick
 
 class ComponentBase
 {
 public:
-	ComponentBase(const char* componentName, const char *queueName, int priority);
-	virtual ~ComponentBase() {};
+	ComponentBase(const char* componentName, const char *queueName, int priority, float fTickPeriod = 0.0);
+	virtual ~ComponentBase();
 
 	void DoWork();
+	void Step();
 	void SendMessage(RobotMessage* robotMessage);
+	void Subscribe(int iTopic);
 	void ClearMessages();
 
-	char* GetComponentName();
+	const char* GetComponentName();
+
+	///when set before any component is built, none of them start their own task
+	static void SetExecutorMode(bool bEnable) { bExecutorMode = bEnable; };
+	static bool IsExecutorMode() { return(bExecutorMode); };
 	int GetLoop() { return(iLoop); };
+	float GetTickPeriod() { return(fTickPeriod); };
+	unsigned GetTickOverruns() { return(pTickTimer ? pTickTimer->GetOverruns() : 0); };
+	float GetTickJitterMax() { return(pTickTimer ? pTickTimer->GetJitterMax() : 0.0); };
+	float GetTickJitterAvg() { return(pTickTimer ? pTickTimer->GetJitterAvg() : 0.0); };
+	unsigned GetRunMax() { return(runTime.GetMax()); };
+	unsigned GetRunP99() { return(runTime.GetPercentile(99.0)); };
+	unsigned GetBudgetOverruns() { return(uBudgetOverruns); };
 
 protected:
 	Task *pTask;
@@ -51,16 +68,48 @@ protected:
 	///used to send a message back to autonomous or whatever to notify completion of a function
 	void SendCommandResponse(MessageCommand);
 
+	///how long a single Run() may take before we complain about it (seconds)
+	void SetRunBudget(float fBudget) { uRunBudgetUs = (unsigned)(fBudget * 1000000.0); };
+
 private:
+	MessageQueue *pQueue;
+	RobotMessage batch[MESSAGE_BATCH_SIZE];	// taken from the mailbox in one pass
+	unsigned uBatchCount;
+	unsigned uBatchNext;				// next one to hand to HandleMessage()
+
 	const float fUpdateDelay = .15;
-	char* componentName;
-	string queueLocal;
-	int iPipeRcv;
-	int iPipeXmt;
-	int iPipeRpt;
+	const int iMessageTimeoutUs = 40000;
+
+	const char* componentName;
+	int iPriority;						// SCHED_FIFO priority if THREAD_PARAMS has none
+	float fTickPeriod;					// seconds, 0.0 runs once per message
+	PeriodicTimer *pTickTimer;			// NULL unless we run on a tick
+	long long llLastMessageUs;			// for the timeout when Step() finds nothing
+	long long llLastReportUs;			// when the mailbox stats were last published
+
+	unsigned uTraceSource;				// stamped on every message we send
+	bool bMatchRunning;					// dump the traces when the match is over
+	Histogram *pQueueDelay;				// per command, send to start of handling
+	Histogram *pHandleTime;				// per command, time spent in Run()
+
+	static std::atomic<unsigned> uNextTraceSource;
+	static bool bExecutorMode;
+
+	Histogram runTime;					// every Run(), microseconds
+	Histogram loopInterval;				// start of one Run() to the next, microseconds
+	long long llLastRunUs;				// when the last Run() started
+	unsigned uRunBudgetUs;				// Run() longer than this is an overrun
+	unsigned uBudgetOverruns;			// how many there have been
+	MessageCommand worstCommand;		// what we were doing during the longest Run()
+	long long llLastOverrunReportUs;	// so a slow loop does not flood the console
+
+	void ProfileRun(long long llStartUs, long long llEndUs);
 
-	void ReceiveMessage();
+	void HandleBatch();
 	void ReportMessage();
+	void DumpTrace(const char *szReason, bool bClear);
+	void HandleMessage();
+	void DoTickedWork();
 };
 
 #endif //COMPONENT_BASE_H
@@ -0,0 +1,99 @@
+/** \file
+ * Runs every component from a single task in a fixed order.
+ */
+
+#include <math.h>
+#include <time.h>
+
+#include <ComponentExecutor.h>
+#include <RobotClock.h>
+#include <RobotParams.h>
+
+ComponentExecutor::ComponentExecutor(float fTickPeriod) : tickTimer(fTickPeriod)
+{
+	pTask = NULL;
+	fCpuPercent = 0.0;
+}
+
+ComponentExecutor::~ComponentExecutor()
+{
+	delete pTask;
+}
+
+void ComponentExecutor::Add(ComponentBase *pComponent)
+{
+	Entry entry;
+	float fTickPeriod = pComponent->GetTickPeriod();
+
+	// components must all be added before Start(), the list is not locked
+
+	wpi_assert(pTask == NULL);
+
+	entry.pComponent = pComponent;
+	entry.uDivider = 1;
+
+	if(fTickPeriod > tickTimer.GetPeriod())
+	{
+		entry.uDivider = (unsigned)lround(fTickPeriod / tickTimer.GetPeriod());
+	}
+
+	components.push_back(entry);
+}
+
+void ComponentExecutor::Start()
+{
+	pTask = new Task(EXECUTOR_TASKNAME, &ComponentExecutor::StartTask, this);
+	wpi_assert(pTask);
+}
+
+void ComponentExecutor::Run()
+{
+	struct timespec cpuStart;
+	struct timespec cpuNow;
+	long long llWallStartUs;
+	long long llWallNowUs;
+	unsigned uUpdateTicks = (unsigned)(fUpdateDelay / tickTimer.GetPeriod());
+	unsigned uTick = 0;
+
+	ThreadConfig::Apply(EXECUTOR_TASKNAME, EXECUTOR_PRIORITY);
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuStart);
+	llWallStartUs = RobotClock::NowUs();
+	tickTimer.Start();
+
+	while(true)
+	{
+		tickTimer.WaitForNextTick();
+
+		for(unsigned i = 0; i < components.size(); ++i)
+		{
+			if((uTick % components[i].uDivider) == 0)
+			{
+				components[i].pComponent->Step();
+			}
+		}
+
+		if((++uTick % uUpdateTicks) == 0)
+		{
+			// how busy have we been since the last update?
+
+			clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuNow);
+			llWallNowUs = RobotClock::NowUs();
+
+			fCpuPercent = 100.0 * ((cpuNow.tv_sec - cpuStart.tv_sec) * 1000000.0 +
+					(cpuNow.tv_nsec - cpuStart.tv_nsec) / 1000.0) / RobotClock::RealUs(llWallNowUs - llWallStartUs);
+
+			cpuStart = cpuNow;
+			llWallStartUs = llWallNowUs;
+			Report();
+		}
+	}
+}
+
+void ComponentExecutor::Report()
+{
+	SmartDashboard::PutNumber("executor cpu %", fCpuPercent);
+	SmartDashboard::PutNumber("executor overruns", tickTimer.GetOverruns());
+	SmartDashboard::PutNumber("executor jitter avg us", tickTimer.GetJitterAvg());
+	SmartDashboard::PutNumber("executor jitter max us", tickTimer.GetJitterMax());
+}
@@ -0,0 +1,61 @@
+/** \file
+ * Runs every component from a single task in a fixed order.
+ *
+ * Normally each component has its own task and the scheduler decides who
+ * reacts to a driver station packet first.  In executor mode (EXECUTOR_MODE in
+ * RobotParams.h) no component starts a task of its own.  Instead this class
+ * wakes up every EXECUTOR_TICK_PERIOD and calls Step() on each component in
+ * the order they were added.  Ticked components are stepped on every multiple
+ * of their own period, message driven components every tick.
+ *
+ * Everything shares one thread, so a handler that blocks, like a Wait() inside
+ * Run(), holds up every other component until it returns.
+ */
+
+#ifndef COMPONENT_EXECUTOR_H
+#define COMPONENT_EXECUTOR_H
+
+#include <vector>
+
+//Robot
+#include <ComponentBase.h>
+#include <PeriodicTimer.h>
+
+class ComponentExecutor
+{
+public:
+	ComponentExecutor(float fTickPeriod);
+	~ComponentExecutor();
+
+	void Add(ComponentBase *pComponent);
+	void Start();
+
+	unsigned GetTickOverruns() { return(tickTimer.GetOverruns()); };
+	float GetTickJitterMax() { return(tickTimer.GetJitterMax()); };
+	float GetTickJitterAvg() { return(tickTimer.GetJitterAvg()); };
+	float GetCpuPercent() { return(fCpuPercent); };
+
+	static void *StartTask(void *pThis)
+	{
+		((ComponentExecutor *)pThis)->Run();
+		return(NULL);
+	}
+
+private:
+	struct Entry {
+		ComponentBase *pComponent;
+		unsigned uDivider;				// step every this many ticks
+	};
+
+	const float fUpdateDelay = 1.0;		// seconds between dashboard updates
+
+	std::vector<Entry> components;
+	PeriodicTimer tickTimer;
+	Task *pTask;
+	float fCpuPercent;					// of one CPU, over the last update
+
+	void Run();
+	void Report();
+};
+
+#endif //COMPONENT_EXECUTOR_H
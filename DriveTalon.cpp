@@ -9,12 +9,13 @@
 #include <iostream>
 #include <fstream>
 #include <RobotParams.h>
+#include <ThreadConfig.h>
 
 DriveTalon::DriveTalon(int canid) : CANTalon(canid){
 	cand = canid;
 	path += std::to_string(cand)+".txt";
 	pCurrentTimer = new Timer();
-	pTask = new Task("drive"+canid, &DriveTalon::StartTask, this);
+	pTask = new Task(TALON_TASKNAME + std::to_string(cand), &DriveTalon::StartTask, this);
 	wpi_assert(pTask);
 }
 
@@ -23,6 +24,7 @@ DriveTalon::~DriveTalon() {
 }
 
 void DriveTalon::Run(){
+	ThreadConfig::Apply((TALON_TASKNAME + std::to_string(cand)).c_str(), TALON_PRIORITY);
 
 	for(;;){
 		float currentCurrent = this->GetOutputCurrent();
@@ -10,6 +10,7 @@
 
 #include "WPILib.h"
 #include <string>
+#include <RobotParams.h>
 
 class DriveTalon : public CANTalon{
 public:
@@ -33,7 +34,7 @@ private:
 	const float maxCurrentTime = 0.5;
 	int cand;
 	float lastCurrent=0;
-	std::string path = "/home/lvuser/driveCurrent";
+	std::string path = ROBOT_HOME_DIR "driveCurrent";
 };
 
 #endif /* SRC_DRIVETALON_H_ */
@@ -30,10 +30,16 @@ using namespace std;
 
 Drivetrain::Drivetrain() :
 		ComponentBase(DRIVETRAIN_TASKNAME, DRIVETRAIN_QUEUE,
-				DRIVETRAIN_PRIORITY) {
+				DRIVETRAIN_PRIORITY, DRIVETRAIN_TICK_PERIOD) {
 
 	fMaxVelLeft = 0;
 	fMaxVelRight = 0;
+	llLastDashboardUs = 0;
+
+	// battery voltage and the start and end of the autonomous script
+
+	Subscribe(MESSAGE_TOPIC_SYSTEM);
+	Subscribe(MESSAGE_TOPIC_AUTONOMOUS);
 
 	pRunTimer = new Timer();
 	pRunTimer->Start();
@@ -177,41 +183,51 @@ void Drivetrain::OnStateChange()			//Handles state changes
 
 ///fNextLeft + , fNextRight -
 void Drivetrain::Run() {
+	long long llNowUs = PeriodicTimer::NowUs();
+	float fVelRight = pRightOneMotor->GetSpeed();
+	float fVelLeft = pLeftOneMotor->GetSpeed();
+
 	//float fCentroid;
  	//SmartDashboard::PutBoolean("On Target", pCamera->GetCentroid(fCentroid));
   	//SmartDashboard::PutNumber("Centroid", fCentroid);
 
- 	SmartDashboard::PutNumber("travelenc", pRightOneMotor->GetEncPosition());
- 	SmartDashboard::PutNumber("distenc", fStraightDriveDistance * (TALON_COUNTSPERREV * REVSPERFOOT));
- 	SmartDashboard::PutNumber("pixycam", pAPixy->Get());
+	// the peaks are caught every tick, everything else is only read for the dashboard
 
- 	SmartDashboard::PutNumber("velocity Right", pRightOneMotor->GetSpeed());
- 	SmartDashboard::PutNumber("velocity Left", pLeftOneMotor->GetSpeed());
-	SmartDashboard::PutNumber("Gyro", pGyro->GetAngle());
+ 	if(abs(fVelRight)>abs(fMaxVelRight))
+ 		fMaxVelRight = fVelRight;
 
-	SmartDashboard::PutBoolean("Red Sensor", !pLaserReturn->Get());
+ 	if(abs(fVelLeft)>abs(fMaxVelLeft))
+ 		fMaxVelLeft = fVelLeft;
+
+	if(llNowUs - llLastDashboardUs >= (long long)(fDashboardPeriod * 1000000.0))
+	{
+		llLastDashboardUs = llNowUs;
 
-	float avgAmp = 0;
-	avgAmp+=pLeftOneMotor->GetOutputCurrent();
-	avgAmp+=pLeftTwoMotor->GetOutputCurrent();
-	avgAmp+=pRightOneMotor->GetOutputCurrent();
-	avgAmp+=pRightTwoMotor->GetOutputCurrent();
-	avgAmp/=4;
+		SmartDashboard::PutNumber("travelenc", pRightOneMotor->GetEncPosition());
+		SmartDashboard::PutNumber("distenc", fStraightDriveDistance * (TALON_COUNTSPERREV * REVSPERFOOT));
+		SmartDashboard::PutNumber("pixycam", pAPixy->Get());
 
-	SmartDashboard::PutNumber("ave drivetrain Amps", avgAmp);
+		SmartDashboard::PutNumber("velocity Right", fVelRight);
+		SmartDashboard::PutNumber("velocity Left", fVelLeft);
+		SmartDashboard::PutNumber("Gyro", pGyro->GetAngle());
 
-	SmartDashboard::PutNumber("left raw", -pLeftOneMotor->GetEncPosition());
-	SmartDashboard::PutNumber("right raw", pRightOneMotor->GetEncPosition());
+		SmartDashboard::PutBoolean("Red Sensor", !pLaserReturn->Get());
 
+		float avgAmp = 0;
+		avgAmp+=pLeftOneMotor->GetOutputCurrent();
+		avgAmp+=pLeftTwoMotor->GetOutputCurrent();
+		avgAmp+=pRightOneMotor->GetOutputCurrent();
+		avgAmp+=pRightTwoMotor->GetOutputCurrent();
+		avgAmp/=4;
 
- 	if(abs(pRightOneMotor->GetSpeed())>abs(fMaxVelRight))
- 		fMaxVelRight = pRightOneMotor->GetSpeed();
+		SmartDashboard::PutNumber("ave drivetrain Amps", avgAmp);
 
- 	if(abs(pLeftOneMotor->GetSpeed())>abs(fMaxVelLeft))
- 		fMaxVelLeft = pLeftOneMotor->GetSpeed();
+		SmartDashboard::PutNumber("left raw", -pLeftOneMotor->GetEncPosition());
+		SmartDashboard::PutNumber("right raw", pRightOneMotor->GetEncPosition());
 
- 	SmartDashboard::PutNumber("Max V Left", fMaxVelLeft);
- 	SmartDashboard::PutNumber("Max V Right", fMaxVelRight);
+		SmartDashboard::PutNumber("Max V Left", fMaxVelLeft);
+		SmartDashboard::PutNumber("Max V Right", fMaxVelRight);
+	}
 
  	switch(localMessage.command) {
 	case COMMAND_DRIVETRAIN_DRIVE_TANK:
@@ -220,13 +236,13 @@ void Drivetrain::Run() {
 
 		if(bUnderServoControl)
 		{
-			pLeftOneMotor->Set(-pow(localMessage.params.tankDrive.left, 3.0) * FULLSPEED_FROMTALONS);
-			pRightOneMotor->Set(pow(localMessage.params.tankDrive.right, 3.0) * FULLSPEED_FROMTALONS);
+			pLeftOneMotor->Set(-pow(GetParams<COMMAND_DRIVETRAIN_DRIVE_TANK>(localMessage).left, 3.0) * FULLSPEED_FROMTALONS);
+			pRightOneMotor->Set(pow(GetParams<COMMAND_DRIVETRAIN_DRIVE_TANK>(localMessage).right, 3.0) * FULLSPEED_FROMTALONS);
 		}
 		else
 		{
-			pLeftOneMotor->Set(-pow(localMessage.params.tankDrive.left,3.0));
-			pRightOneMotor->Set(pow(localMessage.params.tankDrive.right, 3.0));
+			pLeftOneMotor->Set(-pow(GetParams<COMMAND_DRIVETRAIN_DRIVE_TANK>(localMessage).left,3.0));
+			pRightOneMotor->Set(pow(GetParams<COMMAND_DRIVETRAIN_DRIVE_TANK>(localMessage).right, 3.0));
 		}
 		break;
 
@@ -234,15 +250,23 @@ void Drivetrain::Run() {
 		bDrivingStraight = false;
 		bTurning = false;
 
+		// a disable or mode change can be delivered ahead of a move sent
+		// before it, do not let the stale move start the motors again
+
+		if(!ISAUTO || !ISENABLED)
+		{
+			break;
+		}
+
 		if(bUnderServoControl)
 		{
-			pLeftOneMotor->Set(localMessage.params.tankDrive.left * FULLSPEED_FROMTALONS);
-			pRightOneMotor->Set(localMessage.params.tankDrive.right * FULLSPEED_FROMTALONS);
+			pLeftOneMotor->Set(GetParams<COMMAND_DRIVETRAIN_AUTO_MOVE>(localMessage).left * FULLSPEED_FROMTALONS);
+			pRightOneMotor->Set(GetParams<COMMAND_DRIVETRAIN_AUTO_MOVE>(localMessage).right * FULLSPEED_FROMTALONS);
 		}
 		else
 		{
-			pLeftOneMotor->Set(localMessage.params.tankDrive.left);
-			pRightOneMotor->Set(localMessage.params.tankDrive.right);
+			pLeftOneMotor->Set(GetParams<COMMAND_DRIVETRAIN_AUTO_MOVE>(localMessage).left);
+			pRightOneMotor->Set(GetParams<COMMAND_DRIVETRAIN_AUTO_MOVE>(localMessage).right);
 		}
 		break;
 	case COMMAND_DRIVETRAIN_SETANGLE:
@@ -252,20 +276,20 @@ void Drivetrain::Run() {
 			bTurning = false;
 			bDrivingStraight = false;
 
-			RunSplitArcade(localMessage.params.splitArcadeDrive.wheel,
-					localMessage.params.splitArcadeDrive.throttle,
-					localMessage.params.splitArcadeDrive.spin);
+			RunSplitArcade(GetParams<COMMAND_DRIVETRAIN_DRIVE_SPLITARCADE>(localMessage).wheel,
+					GetParams<COMMAND_DRIVETRAIN_DRIVE_SPLITARCADE>(localMessage).throttle,
+					GetParams<COMMAND_DRIVETRAIN_DRIVE_SPLITARCADE>(localMessage).spin);
 
 			// contribute to the cheezy Kalmanfilter
 
-			if(fabs(localMessage.params.splitArcadeDrive.spin) > 0.05)
+			if(fabs(GetParams<COMMAND_DRIVETRAIN_DRIVE_SPLITARCADE>(localMessage).spin) > 0.05)
 			{
-				RunCheezyDrive(false, localMessage.params.splitArcadeDrive.wheel, 0.0, false);
+				RunCheezyDrive(false, GetParams<COMMAND_DRIVETRAIN_DRIVE_SPLITARCADE>(localMessage).wheel, 0.0, false);
 			}
 			else
 			{
-				RunCheezyDrive(false, localMessage.params.splitArcadeDrive.wheel,
-						localMessage.params.splitArcadeDrive.throttle, false);
+				RunCheezyDrive(false, GetParams<COMMAND_DRIVETRAIN_DRIVE_SPLITARCADE>(localMessage).wheel,
+						GetParams<COMMAND_DRIVETRAIN_DRIVE_SPLITARCADE>(localMessage).throttle, false);
 			}
 			break;
 
@@ -273,7 +297,7 @@ void Drivetrain::Run() {
 		bTurning = false;
 		bDrivingStraight = false;
 
-		if(localMessage.params.cheezyDrive.throttle < 0.1 && localMessage.params.cheezyDrive.throttle > -0.1){
+		if(GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(localMessage).throttle < 0.1 && GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(localMessage).throttle > -0.1){
 
 			bSearchLastFrame = false;
 			pLeftOneMotor->ResetCurrentTimeout();
@@ -287,8 +311,8 @@ void Drivetrain::Run() {
 
 			}else{
 				if(!bRedSensing){
-				RunCheezyDrive(true, localMessage.params.cheezyDrive.wheel,
-						localMessage.params.cheezyDrive.throttle, localMessage.params.cheezyDrive.bQuickturn);
+				RunCheezyDrive(true, GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(localMessage).wheel,
+						GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(localMessage).throttle, GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(localMessage).bQuickturn);
 				}
 			}
 
@@ -297,12 +321,12 @@ void Drivetrain::Run() {
 			bRedSensing = false;
 
 			if(!bRedSensing){
-			RunCheezyDrive(true, localMessage.params.cheezyDrive.wheel,
-					localMessage.params.cheezyDrive.throttle, localMessage.params.cheezyDrive.bQuickturn);
+			RunCheezyDrive(true, GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(localMessage).wheel,
+					GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(localMessage).throttle, GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(localMessage).bQuickturn);
 			}
 		}
 
-		if(localMessage.params.cheezyDrive.bQuickturn){
+		if(GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(localMessage).bQuickturn){
 			bRedSensing = false;
 		}
 
@@ -313,36 +337,36 @@ void Drivetrain::Run() {
  		bMeasuredMoveToLine = false;
  		bMeasuredMove = true;
  		bTurning = false;
- 		StartStraightDrive(localMessage.params.autonomous.driveSpeed,
- 				15.0, localMessage.params.autonomous.driveDistance);
- 		RunCheezyDrive(false, 0.0, localMessage.params.autonomous.driveSpeed, false);
+ 		StartStraightDrive(GetParams<COMMAND_DRIVETRAIN_MSTRAIGHT>(localMessage).driveSpeed,
+ 				15.0, GetParams<COMMAND_DRIVETRAIN_MSTRAIGHT>(localMessage).driveDistance);
+ 		RunCheezyDrive(false, 0.0, GetParams<COMMAND_DRIVETRAIN_MSTRAIGHT>(localMessage).driveSpeed, false);
  		break;
 
 	case COMMAND_DRIVETRAIN_MLINE:
  		bMeasuredMoveToLine = true;
  		bMeasuredMove = false;
  		bTurning = false;
- 		StartStraightDrive(localMessage.params.autonomous.driveSpeed,
- 				15.0, localMessage.params.autonomous.driveDistance);
- 		RunCheezyDrive(false, 0.0, localMessage.params.autonomous.driveSpeed, false);
+ 		StartStraightDrive(GetParams<COMMAND_DRIVETRAIN_MLINE>(localMessage).driveSpeed,
+ 				15.0, GetParams<COMMAND_DRIVETRAIN_MLINE>(localMessage).driveDistance);
+ 		RunCheezyDrive(false, 0.0, GetParams<COMMAND_DRIVETRAIN_MLINE>(localMessage).driveSpeed, false);
  		break;
 
 	case COMMAND_DRIVETRAIN_STRAIGHT:
 		bMeasuredMoveToLine = false;
 		bMeasuredMove = false;
 		bTurning = false;
-		StartStraightDrive(localMessage.params.autonomous.driveSpeed,
-		 				localMessage.params.autonomous.timeout, 54.0);
-		RunCheezyDrive(false, 0.0, localMessage.params.autonomous.driveSpeed, false);
+		StartStraightDrive(GetParams<COMMAND_DRIVETRAIN_STRAIGHT>(localMessage).driveSpeed,
+		 				GetParams<COMMAND_DRIVETRAIN_STRAIGHT>(localMessage).timeout, 54.0);
+		RunCheezyDrive(false, 0.0, GetParams<COMMAND_DRIVETRAIN_STRAIGHT>(localMessage).driveSpeed, false);
 		break;
 
 	case COMMAND_DRIVETRAIN_TURN:
 		bDrivingStraight = false;
-		StartTurn(localMessage.params.autonomous.turnAngle,localMessage.params.autonomous.timeout);
+		StartTurn(GetParams<COMMAND_DRIVETRAIN_TURN>(localMessage).turnAngle,GetParams<COMMAND_DRIVETRAIN_TURN>(localMessage).timeout);
 
 		// contribute to cheezy Kalman filter
 
-		if(localMessage.params.autonomous.turnAngle > 0.0)
+		if(GetParams<COMMAND_DRIVETRAIN_TURN>(localMessage).turnAngle > 0.0)
 		{
 			RunCheezyDrive(false, 0.5, 0.0, false);
 		}
@@ -363,11 +387,11 @@ void Drivetrain::Run() {
 		break;
 
 	case COMMAND_SYSTEM_CONSTANTS:
-		fBatteryVoltage = localMessage.params.system.fBattery;
+		fBatteryVoltage = GetParams<COMMAND_SYSTEM_CONSTANTS>(localMessage).fBattery;
 		break;
 
 	case COMMAND_AUTONOMOUS_SEARCHGOAL:
-		bSearching = localMessage.params.armParams.direction;
+		bSearching = GetParams<COMMAND_AUTONOMOUS_SEARCHGOAL>(localMessage).direction;
 		if(ISAUTO){
 			printf("is auto\n");
 			bSearching = true;
@@ -496,7 +520,13 @@ void Drivetrain::StartStraightDrive (float speed, float time, float distance)
 	//DO NOT RESET THE GYRO EVER. only zeroing.
 	//pGyro->Zero();		//DO NOT RESET THE GYRO EVER. only zeroing.
 	pLeftOneMotor->SetEncPosition(0);
-	while(pRightOneMotor->GetEncPosition()!=0){
+	pRightOneMotor->SetEncPosition(0);
+
+	// the talon takes a moment to report the reset.  We run at FIFO priority,
+	// so wait for it a little at a time instead of spinning, and not forever
+	for(int i = 0; (i < ENCODER_RESET_TRIES) && (pRightOneMotor->GetEncPosition() != 0); i++)
+	{
+		Wait(0.001);
 		pRightOneMotor->SetEncPosition(0);
 	}
 
@@ -656,6 +686,9 @@ void Drivetrain::Search(){
 			}
 
 		}
+
+		// the drivetrain runs at FIFO priority, give the pixy and everyone else a turn
+		Wait(0.005);
 	}
 	if(ISAUTO){
 		SendCommandResponse(command);
@@ -969,39 +1002,53 @@ void Drivetrain::RunCheezyDrive(bool bEnabled, float fWheel, float fThrottle, bo
     }
 }
 
-CheezyLoop::CheezyLoop()
+CheezyLoop::CheezyLoop(bool bStartTask)
 {
 	bOutputEnabled = false;
 	CheezyInit1296();  // initialize the cheezy drive code base
 
-	pTask = new Task("tCheezy", &CheezyLoop::Run, this);
+	pTask = bStartTask ? new Task(CHEEZY_TASKNAME, &CheezyLoop::Run, this) : NULL;
+
+	// we have no mailbox, but we must stop driving the instant the mode changes
+
+	MessageBus::Subscribe(MESSAGE_TOPIC_ROBOT_STATE, &CheezyLoop::OnStateChange, this);
+}
+
+void CheezyLoop::OnStateChange(void *pThis, const RobotMessage *pMessage)
+{
+	CheezyLoop *pInstance = (CheezyLoop *)pThis;
+
+	// Drivetrain turns the output back on with the next teleop update
+
+	std::lock_guard<priority_recursive_mutex> sync(pInstance->mutexData);
+	pInstance->bOutputEnabled = false;
 }
 
 void CheezyLoop::Run(CheezyLoop *pInstance)
 {
+	ThreadConfig::Apply(CHEEZY_TASKNAME, CHEEZY_PRIORITY);
+
 	 while(true)
 	 {
 		 Wait(0.005);
-
-		 if(pInstance->bOutputEnabled)
-		{
-			 std::lock_guard<priority_recursive_mutex> sync(pInstance->mutexData);
-			 CheezyIterate1296(&pInstance->currentGoal,
-					 &pInstance->currentPosition,
-					 &pInstance->currentOutput,
-					 &pInstance->currentStatus);
-		}
-		else
-		{
-			 std::lock_guard<priority_recursive_mutex> sync(pInstance->mutexData);
-			 CheezyIterate1296(&pInstance->currentGoal,
-					 &pInstance->currentPosition,
-					 NULL,
-					 &pInstance->currentStatus);
-		}
+		 pInstance->Iterate();
 	 }
 }
 
+void CheezyLoop::Iterate()
+{
+	std::lock_guard<priority_recursive_mutex> sync(mutexData);
+
+	if(bOutputEnabled)
+	{
+		CheezyIterate1296(&currentGoal, &currentPosition, &currentOutput, &currentStatus);
+	}
+	else
+	{
+		CheezyIterate1296(&currentGoal, &currentPosition, NULL, &currentStatus);
+	}
+}
+
 
 
 void CheezyLoop::Update(const DrivetrainGoal &goal,
@@ -1020,5 +1067,6 @@ void CheezyLoop::Update(const DrivetrainGoal &goal,
 }
 
 CheezyLoop::~CheezyLoop(){
+	MessageBus::Unsubscribe(MESSAGE_TOPIC_ROBOT_STATE, this);
 	delete pTask;
 }
@@ -41,6 +41,7 @@ const float TALON_IZONE	=			128;
 const float TALON_COUNTSPERREV =	360;	// from CTRE docs
 const float REVSPERFOOT = (3.141519 * 6.0 / 12.0);
 const double METERS_PER_COUNT = (REVSPERFOOT * 0.3048 / (double)TALON_COUNTSPERREV);
+const int ENCODER_RESET_TRIES =		20;		// 1ms apart, then drive on with what the talon reports
 
 const float fMinimumTurnSpeed = 0.3;
 
@@ -48,9 +49,11 @@ class CheezyLoop {
 
  public:
 
- 	CheezyLoop();
+ 	CheezyLoop(bool bStartTask = true);		// false leaves calling Iterate() to the caller
  	~CheezyLoop();
  	static void Run(CheezyLoop *);
+ 	static void OnStateChange(void *pThis, const RobotMessage *pMessage);
+ 	void Iterate();		// one pass of the loop on the last goal and position
 
 
  	bool bOutputEnabled;
@@ -68,11 +71,6 @@ class CheezyLoop {
  	Task* pTask;
 
  	mutable priority_recursive_mutex mutexData;
-
- 	void Iterate(const DrivetrainGoal *goal,
- 				 const DrivetrainPosition *position,
- 		         DrivetrainOutput *output,
- 		         DrivetrainStatus *status);
  };
 
 
@@ -153,6 +151,10 @@ private:
 
 	float fMaxVelLeft;
 	float fMaxVelRight;
+
+	//the dashboard gets the numbers as often as ComponentBase reports the mailbox, not every tick
+	const float fDashboardPeriod = .15;
+	long long llLastDashboardUs;
 	//diameter*pi/encoder_resolution : 1.875 * 3.14 / 256
 
 	float fAccum = 0;
@@ -0,0 +1,414 @@
+/** \file
+ * Binary flight log of every message sent to any component, and a harness to
+ * play it back.
+ *
+ * The ring between the senders and the writer task is the same bounded queue
+ * MessageQueue uses, every entry carries a sequence number.  Senders claim an
+ * entry, fill it in and publish it, the writer task takes entries in order and
+ * formats them into the file.  An entry a preempted sender has not published
+ * yet just waits for the next flush, so nobody ever waits on anybody else and
+ * a slow SD card only ever costs dropped records, never a stalled sender.
+ */
+
+#include <algorithm>
+#include <string.h>
+#include <time.h>
+
+#include <FlightLog.h>
+#include <PendingResponses.h>
+#include <RobotClock.h>
+#include <RobotParams.h>
+#include <ThreadConfig.h>
+
+FlightLog::Entry FlightLog::ring[FLIGHT_LOG_RING_DEPTH];
+std::atomic<unsigned> FlightLog::uEnqueuePos(0);
+unsigned FlightLog::uDequeuePos = 0;
+std::atomic<MessageQueue *> FlightLog::queues[FLIGHT_LOG_MAX_QUEUES];
+char FlightLog::szQueueNames[FLIGHT_LOG_MAX_QUEUES][FLIGHT_LOG_NAME_SIZE];
+std::atomic<bool> FlightLog::bQueueNamed[FLIGHT_LOG_MAX_QUEUES];
+bool FlightLog::bNameLogged[FLIGHT_LOG_MAX_QUEUES];
+unsigned char FlightLog::buffer[FLIGHT_LOG_BUFFER_SIZE];
+unsigned FlightLog::uFill = 0;
+long long FlightLog::llStartUs = 0;
+FILE *FlightLog::pFile = NULL;
+std::thread FlightLog::writer;
+std::atomic<bool> FlightLog::bRunning(false);
+std::atomic<unsigned> FlightLog::uRecords(0);
+std::atomic<unsigned> FlightLog::uDropped(0);
+std::atomic<unsigned long long> FlightLog::ullBytes(0);
+
+bool FlightLog::Start(const char *szFileName)
+{
+	FlightLogHeader header;
+
+	if(bRunning.load())
+	{
+		return(false);
+	}
+
+	pFile = fopen(szFileName, "wb");
+
+	if(pFile == NULL)
+	{
+		printf("FlightLog: can not open %s\n", szFileName);
+		return(false);
+	}
+
+	memcpy(header.szMagic, FLIGHT_LOG_MAGIC, sizeof(header.szMagic));
+	header.uVersion = FLIGHT_LOG_VERSION;
+	fwrite(&header, sizeof(header), 1, pFile);
+
+	for(unsigned i = 0; i < FLIGHT_LOG_RING_DEPTH; ++i)
+	{
+		ring[i].uSequence.store(i, std::memory_order_relaxed);
+	}
+
+	for(unsigned i = 0; i < FLIGHT_LOG_MAX_QUEUES; ++i)
+	{
+		queues[i].store(NULL, std::memory_order_relaxed);
+		bQueueNamed[i].store(false, std::memory_order_relaxed);
+		bNameLogged[i] = false;
+	}
+
+	uEnqueuePos.store(0, std::memory_order_relaxed);
+	uDequeuePos = 0;
+	uFill = 0;
+	llStartUs = MessageQueue::GetTraceTimeUs();
+
+	bRunning.store(true);
+	writer = std::thread(&FlightLog::Writer);
+	MessageQueue::SetTap(&FlightLog::Tap);
+	return(true);
+}
+
+void FlightLog::Stop()
+{
+	if(!bRunning.exchange(false))
+	{
+		return;
+	}
+
+	MessageQueue::SetTap(NULL);
+	writer.join();
+	Flush();
+	fclose(pFile);
+	pFile = NULL;
+}
+
+void FlightLog::GetStats(unsigned &uRecordCount, unsigned &uDroppedCount, unsigned long long &ullByteCount)
+{
+	uRecordCount = uRecords.load(std::memory_order_relaxed);
+	uDroppedCount = uDropped.load(std::memory_order_relaxed);
+	ullByteCount = ullBytes.load(std::memory_order_relaxed);
+}
+
+void FlightLog::Tap(MessageQueue *pQueue, const RobotMessage *pMessage, bool bDropped)
+{
+	Entry *pEntry;
+	int iQueue = FindQueue(pQueue);
+	unsigned uPos = uEnqueuePos.load(std::memory_order_relaxed);
+
+	if(iQueue < 0)
+	{
+		uDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	while(true)
+	{
+		pEntry = &ring[uPos & (FLIGHT_LOG_RING_DEPTH - 1)];
+		int iDiff = (int)pEntry->uSequence.load(std::memory_order_acquire) - (int)uPos;
+
+		if(iDiff == 0)
+		{
+			// the entry is free, try to claim it
+
+			if(uEnqueuePos.compare_exchange_weak(uPos, uPos + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if(iDiff < 0)
+		{
+			// the writer task has fallen behind, never wait for it
+
+			uDropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		else
+		{
+			// another sender got here first
+
+			uPos = uEnqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	pEntry->ullTimeUs = (uint64_t)(MessageQueue::GetTraceTimeUs() - llStartUs);
+	pEntry->uCommand = pMessage->command;
+	pEntry->uQueue = (uint8_t)iQueue;
+	pEntry->uSize = (uint8_t)GetParamsSize(pMessage->command);
+	pEntry->uFlags = bDropped ? FLIGHT_RECORD_DROPPED : 0;
+	memcpy(&pEntry->params, &pMessage->params, pEntry->uSize);
+	pEntry->uSequence.store(uPos + 1, std::memory_order_release);
+
+	uRecords.fetch_add(1, std::memory_order_relaxed);
+}
+
+int FlightLog::FindQueue(MessageQueue *pQueue)
+{
+	MessageQueue *pFound;
+
+	for(unsigned i = 0; i < FLIGHT_LOG_MAX_QUEUES; ++i)
+	{
+		pFound = queues[i].load(std::memory_order_acquire);
+
+		if(pFound == pQueue)
+		{
+			return(i);
+		}
+
+		if((pFound == NULL) && queues[i].compare_exchange_strong(pFound, pQueue, std::memory_order_acq_rel))
+		{
+			// first message to this queue, keep its name for the writer task,
+			// the queue may be gone by the time the record is written
+
+			strncpy(szQueueNames[i], pQueue->GetName(), FLIGHT_LOG_NAME_SIZE - 1);
+			szQueueNames[i][FLIGHT_LOG_NAME_SIZE - 1] = '\0';
+			bQueueNamed[i].store(true, std::memory_order_release);
+			return(i);
+		}
+
+		if(pFound == pQueue)
+		{
+			return(i);				// another sender claimed it for the same queue
+		}
+	}
+
+	return(-1);
+}
+
+void FlightLog::Append(uint64_t ullTimeUs, uint16_t uCommand, unsigned uQueue, uint32_t uFlags,
+		const void *pData, unsigned uSize)
+{
+	FlightRecord record;
+
+	if(uFill + sizeof(record) + uSize > FLIGHT_LOG_BUFFER_SIZE)
+	{
+		Write();
+	}
+
+	record.ullTimeUs = ullTimeUs;
+	record.uCommand = uCommand;
+	record.uQueue = (uint8_t)uQueue;
+	record.uSize = (uint8_t)uSize;
+	record.uFlags = uFlags;
+
+	memcpy(&buffer[uFill], &record, sizeof(record));
+	memcpy(&buffer[uFill + sizeof(record)], pData, uSize);
+	uFill += sizeof(record) + uSize;
+}
+
+void FlightLog::Flush()
+{
+	Entry *pEntry;
+	unsigned uQueue;
+
+	// only this task takes entries, so no claiming on the way out
+
+	while(true)
+	{
+		pEntry = &ring[uDequeuePos & (FLIGHT_LOG_RING_DEPTH - 1)];
+
+		if(pEntry->uSequence.load(std::memory_order_acquire) != uDequeuePos + 1)
+		{
+			break;					// empty, or a sender is still filling it in
+		}
+
+		// a queue is named in the log before the first message sent to it
+
+		uQueue = pEntry->uQueue;
+
+		if(!bNameLogged[uQueue])
+		{
+			if(!bQueueNamed[uQueue].load(std::memory_order_acquire))
+			{
+				break;				// the sender that found the queue is still copying its name
+			}
+
+			Append(pEntry->ullTimeUs, FLIGHT_RECORD_QUEUE_NAME, uQueue, 0, szQueueNames[uQueue],
+					strlen(szQueueNames[uQueue]));
+			bNameLogged[uQueue] = true;
+		}
+
+		Append(pEntry->ullTimeUs, pEntry->uCommand, uQueue, pEntry->uFlags, &pEntry->params, pEntry->uSize);
+		pEntry->uSequence.store(uDequeuePos + FLIGHT_LOG_RING_DEPTH, std::memory_order_release);
+		uDequeuePos++;
+	}
+
+	Write();
+}
+
+void FlightLog::Write()
+{
+	if(uFill)
+	{
+		fwrite(buffer, 1, uFill, pFile);
+		fflush(pFile);
+		ullBytes.fetch_add(uFill, std::memory_order_relaxed);
+		uFill = 0;
+	}
+}
+
+void FlightLog::Writer()
+{
+	ThreadConfig::Apply(FLIGHT_LOG_TASKNAME, FLIGHT_LOG_PRIORITY);
+
+	while(bRunning.load())
+	{
+		RobotClock::Sleep(FLIGHT_LOG_FLUSH_PERIOD);
+		Flush();
+	}
+}
+
+FlightReplay::FlightReplay()
+{
+	uSent = 0;
+	uResponses = 0;
+	uLateMaxUs = 0;
+	fDuration = 0.0;
+}
+
+bool FlightReplay::Load(const char *szFileName)
+{
+	FILE *pLogFile = fopen(szFileName, "rb");
+	FlightLogHeader header;
+	unsigned char chunk[4096];
+	size_t uRead;
+
+	log.clear();
+
+	if(pLogFile == NULL)
+	{
+		printf("FlightReplay: can not open %s\n", szFileName);
+		return(false);
+	}
+
+	if((fread(&header, sizeof(header), 1, pLogFile) != 1) ||
+			memcmp(header.szMagic, FLIGHT_LOG_MAGIC, sizeof(header.szMagic)) ||
+			(header.uVersion != FLIGHT_LOG_VERSION))
+	{
+		printf("FlightReplay: %s is not a flight log\n", szFileName);
+		fclose(pLogFile);
+		return(false);
+	}
+
+	while((uRead = fread(chunk, 1, sizeof(chunk), pLogFile)) > 0)
+	{
+		log.insert(log.end(), chunk, chunk + uRead);
+	}
+
+	fclose(pLogFile);
+	return(true);
+}
+
+bool FlightReplay::Run(const char *szQueueName, float fSpeed)
+{
+	// components keep the reply queue in their endpoint cache, so it has to outlive us
+
+	static MessageQueue *pReplies = new MessageQueue(FLIGHT_REPLAY_QUEUE);
+	MessageQueue *pTarget = MessageQueue::Open(szQueueName);
+	std::vector<bool> bTarget(FLIGHT_LOG_MAX_QUEUES, false);
+	FlightRecord record;
+	RobotMessage message;
+	RobotMessage reply;
+	long long llStartUs;
+	long long llNowUs;
+	long long llDueUs;
+	long long llFirstUs = -1;
+	unsigned uPos = 0;
+
+	uSent = 0;
+	uResponses = 0;
+	uLateMaxUs = 0;
+
+	if(pTarget == NULL)
+	{
+		printf("FlightReplay: no queue named %s\n", szQueueName);
+		return(false);
+	}
+
+	pReplies->Clear();
+	llStartUs = MessageQueue::GetTraceTimeUs();
+
+	while(uPos + sizeof(record) <= log.size())
+	{
+		memcpy(&record, &log[uPos], sizeof(record));
+		uPos += sizeof(record);
+
+		if(uPos + record.uSize > log.size())
+		{
+			break;					// the log was cut off mid record
+		}
+
+		if(record.uQueue >= FLIGHT_LOG_MAX_QUEUES)
+		{
+			printf("FlightReplay: bad queue %u at offset %u, stopping\n", record.uQueue,
+					(unsigned)(uPos - sizeof(record)));
+			break;					// corrupt, nothing after this can be trusted
+		}
+
+		if(record.uCommand == FLIGHT_RECORD_QUEUE_NAME)
+		{
+			bTarget[record.uQueue] = (record.uSize == strlen(szQueueName)) &&
+					(memcmp(&log[uPos], szQueueName, record.uSize) == 0);
+		}
+		else if(bTarget[record.uQueue] && (record.uCommand < COMMAND_LAST) &&
+				!(record.uFlags & FLIGHT_RECORD_DROPPED))	// the component never got these
+		{
+			// keep the original spacing, squeezed by the speed up
+
+			if(llFirstUs < 0)
+			{
+				llFirstUs = (long long)record.ullTimeUs;
+			}
+
+			if(fSpeed > 0.0)
+			{
+				llDueUs = llStartUs + (long long)(((long long)record.ullTimeUs - llFirstUs) / fSpeed);
+				RobotClock::SleepUntilUs(llDueUs);
+
+				llNowUs = MessageQueue::GetTraceTimeUs();
+
+				if(llNowUs - llDueUs > uLateMaxUs)
+				{
+					uLateMaxUs = (unsigned)(llNowUs - llDueUs);
+				}
+			}
+
+			message.command = (MessageCommand)record.uCommand;
+			message.replyQ = FLIGHT_REPLAY_QUEUE;
+			message.uCorrelation = CORRELATION_NONE;
+			memcpy(&message.params, &log[uPos], std::min((unsigned)record.uSize, (unsigned)sizeof(message.params)));
+			pTarget->Send(&message);
+			uSent++;
+		}
+
+		uPos += record.uSize;
+
+		while(pReplies->TryReceive(&reply))
+		{
+			uResponses++;
+		}
+	}
+
+	fDuration = (MessageQueue::GetTraceTimeUs() - llStartUs) / 1000000.0;
+
+	// give the last commands a moment to answer
+
+	while(pReplies->Receive(&reply, 500000))
+	{
+		uResponses++;
+	}
+
+	return(true);
+}
@@ -0,0 +1,138 @@
+/** \file
+ * Binary flight log of every message sent to any component, and a harness to
+ * play it back.
+ *
+ * FlightLog taps MessageQueue::Send() and records each message, the time since
+ * the log started, the command, which queue it went to and only the parameter
+ * bytes that command uses.  Senders drop the message into a lock-free ring, a
+ * low priority task drains it and writes it out every FLIGHT_LOG_FLUSH_PERIOD.
+ * Senders never take a lock or wait on the disk, if the ring is full the
+ * record is dropped and counted.
+ *
+ * Messages the queue's overflow policy dropped are recorded too, flagged
+ * FLIGHT_RECORD_DROPPED, so the log shows what was lost.
+ *
+ * FlightReplay reads a log back and sends the messages that one queue really
+ * received to that queue again, at the original pace or faster.  Replies the component
+ * sends back go to FLIGHT_REPLAY_QUEUE and are counted.  With the message
+ * traces turned on, the component's own histograms then show what its
+ * handlers cost on real match traffic.
+ */
+
+#ifndef FLIGHT_LOG_H
+#define FLIGHT_LOG_H
+
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+//Robot
+#include <RobotMessage.h>
+#include <MessageQueue.h>
+
+///first bytes of every log file
+const char FLIGHT_LOG_MAGIC[4] = { 'R', 'H', 'S', 'F' };
+const uint32_t FLIGHT_LOG_VERSION = 3;
+
+///messages the senders can get ahead of the writer task, must be a power of two
+const unsigned FLIGHT_LOG_RING_DEPTH = 2048;
+
+///bytes the writer task gathers before each write
+const unsigned FLIGHT_LOG_BUFFER_SIZE = 64 * 1024;
+
+///number of queues a log can tell apart
+const unsigned FLIGHT_LOG_MAX_QUEUES = 32;
+
+///longest queue name a log keeps, with its terminator
+const unsigned FLIGHT_LOG_NAME_SIZE = 32;
+
+///command of a record that names a queue instead of carrying a message
+const uint16_t FLIGHT_RECORD_QUEUE_NAME = 0xFFFF;
+
+///FlightRecord::uFlags bit, the queue's overflow policy threw the message away
+const uint32_t FLIGHT_RECORD_DROPPED = 0x1;
+
+struct FlightLogHeader {
+	char szMagic[4];
+	uint32_t uVersion;
+};
+
+///followed by uSize bytes of parameters, or of queue name
+struct FlightRecord {
+	uint64_t ullTimeUs;			//!< since the log was started, 32 bits ran out after 71 minutes
+	uint16_t uCommand;
+	uint8_t uQueue;				//!< index given by an earlier FLIGHT_RECORD_QUEUE_NAME record
+	uint8_t uSize;
+	uint32_t uFlags;			//!< FLIGHT_RECORD_ bits, the rest zero so no stack garbage reaches the file
+};
+
+class FlightLog
+{
+public:
+	static bool Start(const char *szFileName);
+	static void Stop();
+	static bool IsRunning() { return(bRunning.load(std::memory_order_relaxed)); };
+	static void GetStats(unsigned &uRecords, unsigned &uDropped, unsigned long long &ullBytes);
+
+private:
+	///one message on its way from a sender to the writer task
+	struct Entry {
+		std::atomic<unsigned> uSequence;
+		uint64_t ullTimeUs;
+		uint16_t uCommand;
+		uint8_t uQueue;
+		uint8_t uSize;
+		uint32_t uFlags;
+		MessageParams params;
+	};
+
+	static Entry ring[FLIGHT_LOG_RING_DEPTH];
+	static std::atomic<unsigned> uEnqueuePos;
+	static unsigned uDequeuePos;		// only the writer task takes entries
+	static std::atomic<MessageQueue *> queues[FLIGHT_LOG_MAX_QUEUES];
+	static char szQueueNames[FLIGHT_LOG_MAX_QUEUES][FLIGHT_LOG_NAME_SIZE];
+	static std::atomic<bool> bQueueNamed[FLIGHT_LOG_MAX_QUEUES];
+	static bool bNameLogged[FLIGHT_LOG_MAX_QUEUES];	// writer task only
+	static unsigned char buffer[FLIGHT_LOG_BUFFER_SIZE];
+	static unsigned uFill;
+	static long long llStartUs;
+	static FILE *pFile;
+	static std::thread writer;
+	static std::atomic<bool> bRunning;
+	static std::atomic<unsigned> uRecords;
+	static std::atomic<unsigned> uDropped;
+	static std::atomic<unsigned long long> ullBytes;
+
+	static void Tap(MessageQueue *pQueue, const RobotMessage *pMessage, bool bDropped);
+	static int FindQueue(MessageQueue *pQueue);
+	static void Append(uint64_t ullTimeUs, uint16_t uCommand, unsigned uQueue, uint32_t uFlags,
+			const void *pData, unsigned uSize);
+	static void Flush();
+	static void Write();
+	static void Writer();
+};
+
+class FlightReplay
+{
+public:
+	FlightReplay();
+
+	bool Load(const char *szFileName);
+	bool Run(const char *szQueueName, float fSpeed);
+
+	unsigned GetSent() { return(uSent); };
+	unsigned GetResponses() { return(uResponses); };
+	unsigned GetLateMaxUs() { return(uLateMaxUs); };
+	float GetDuration() { return(fDuration); };
+
+private:
+	std::vector<unsigned char> log;
+	unsigned uSent;
+	unsigned uResponses;
+	unsigned uLateMaxUs;				// furthest behind schedule a message went out
+	float fDuration;					// seconds the replay took
+};
+
+#endif //FLIGHT_LOG_H
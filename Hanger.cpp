@@ -7,7 +7,7 @@
 
 #include <Hanger.h>
 #include <RobotParams.h>
-Hanger::Hanger() : ComponentBase(HANGER_TASKNAME, HANGER_QUEUE, HANGER_PRIORITY){
+Hanger::Hanger() : ComponentBase(HANGER_TASKNAME, HANGER_QUEUE, HANGER_PRIORITY, HANGER_TICK_PERIOD){
 	pHangerMotor = new CANTalon(CAN_HANGER_MOTOR);
 	pHangerMotor->ConfigNeutralMode(CANSpeedController::kNeutralMode_Brake);
 	pHangerMotor->SetControlMode(CANTalon::kPercentVbus);
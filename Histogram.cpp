@@ -0,0 +1,69 @@
+/** \file
+ * Fixed size latency histogram.
+ */
+
+#include <Histogram.h>
+
+Histogram::Histogram()
+{
+	Clear();
+}
+
+void Histogram::Clear()
+{
+	for(unsigned i = 0; i < HISTOGRAM_BUCKETS; ++i)
+	{
+		uBuckets[i] = 0;
+	}
+
+	uCount = 0;
+	ullTotal = 0;
+	uMax = 0;
+}
+
+void Histogram::Add(unsigned uValueUs)
+{
+	unsigned uBucket = 0;
+
+	// find the smallest power of two above the sample
+
+	while((uBucket < HISTOGRAM_BUCKETS - 1) && (uValueUs >> uBucket))
+	{
+		uBucket++;
+	}
+
+	uBuckets[uBucket]++;
+	uCount++;
+	ullTotal += uValueUs;
+
+	if(uValueUs > uMax)
+	{
+		uMax = uValueUs;
+	}
+}
+
+unsigned Histogram::GetPercentile(float fPercent)
+{
+	unsigned uTarget = (unsigned)(uCount * fPercent / 100.0);
+	unsigned uSeen = 0;
+
+	for(unsigned i = 0; i < HISTOGRAM_BUCKETS - 1; ++i)
+	{
+		uSeen += uBuckets[i];
+
+		if(uSeen > uTarget)
+		{
+			// never claim more than we actually saw
+
+			return(((1u << i) < uMax) ? (1u << i) : uMax);
+		}
+	}
+
+	return(uMax);
+}
+
+void Histogram::Print(FILE *pFile, const char *szLabel)
+{
+	fprintf(pFile, "%-32s n=%-7u mean=%8.1f p50<=%-7u p99<=%-7u max=%u\n",
+			szLabel, uCount, GetMean(), GetPercentile(50.0), GetPercentile(99.0), uMax);
+}
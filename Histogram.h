@@ -0,0 +1,41 @@
+/** \file
+ * Fixed size latency histogram.
+ *
+ * Buckets are powers of two microseconds, so recording a sample is a couple of
+ * instructions and needs no memory allocation.  Bucket i holds samples below
+ * 2^i microseconds and the last bucket holds everything longer.  Percentiles
+ * are reported as the top of the bucket they fall in.  A histogram is meant to
+ * be written by a single task.
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdio.h>
+
+///number of buckets, the last one starts at about 4 seconds
+const unsigned HISTOGRAM_BUCKETS = 24;
+
+class Histogram
+{
+public:
+	Histogram();
+
+	void Add(unsigned uValueUs);
+	void Clear();
+
+	unsigned GetCount() { return(uCount); };
+	unsigned GetMax() { return(uMax); };
+	float GetMean() { return(uCount ? (float)ullTotal / uCount : 0.0); };
+	unsigned GetPercentile(float fPercent);
+
+	void Print(FILE *pFile, const char *szLabel);
+
+private:
+	unsigned uBuckets[HISTOGRAM_BUCKETS];
+	unsigned uCount;
+	unsigned long long ullTotal;
+	unsigned uMax;
+};
+
+#endif //HISTOGRAM_H
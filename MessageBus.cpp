@@ -0,0 +1,167 @@
+/** \file
+ * Topic based publish/subscribe on top of the component mailboxes.
+ *
+ * The table never shrinks, so a publisher can read the count and walk that
+ * many entries without a lock.  Unsubscribing marks the entry inactive, then
+ * waits for the publishes that got to it first to finish with it; after that
+ * the entry is free and the next subscriber reuses it.  The fan-out time
+ * recorded for each publish covers copying the message into every mailbox and
+ * running every callback.
+ */
+
+#include <assert.h>
+#include <sched.h>
+#include <stdio.h>
+
+#include <MessageBus.h>
+#include <RobotClock.h>
+
+std::mutex MessageBus::mutexTopics;
+MessageBus::Topic MessageBus::topics[MESSAGE_TOPIC_LAST];
+
+bool MessageBus::Subscribe(int iTopic, MessageQueue *pQueue)
+{
+	return(AddSubscriber(iTopic, pQueue, NULL, pQueue));
+}
+
+bool MessageBus::Subscribe(int iTopic, MessageCallback pCallback, void *pContext)
+{
+	return(AddSubscriber(iTopic, NULL, pCallback, pContext));
+}
+
+bool MessageBus::AddSubscriber(int iTopic, MessageQueue *pQueue, MessageCallback pCallback, void *pContext)
+{
+	assert((iTopic >= 0) && (iTopic < MESSAGE_TOPIC_LAST));
+
+	std::lock_guard<std::mutex> sync(mutexTopics);
+	Topic *pTopic = &topics[iTopic];
+	unsigned uCount = pTopic->uCount.load(std::memory_order_relaxed);
+	unsigned uEntry;
+
+	// an entry someone unsubscribed from first, a new one at the end if there is none
+
+	for(uEntry = 0; uEntry < uCount; ++uEntry)
+	{
+		if(!pTopic->subscribers[uEntry].bActive.load(std::memory_order_relaxed))
+		{
+			break;
+		}
+	}
+
+	if(uEntry >= MESSAGE_BUS_MAX_SUBSCRIBERS)
+	{
+		printf("MessageBus: too many subscribers to topic %d\n", iTopic);
+		return(false);
+	}
+
+	// publishers only read an entry they have seen active, so it can be
+	// filled in while they run.  It is complete before anyone can see it
+
+	pTopic->subscribers[uEntry].pQueue = pQueue;
+	pTopic->subscribers[uEntry].pCallback = pCallback;
+	pTopic->subscribers[uEntry].pContext = pContext;
+	pTopic->subscribers[uEntry].bActive.store(true);
+
+	if(uEntry == uCount)
+	{
+		pTopic->uCount.store(uCount + 1, std::memory_order_release);
+	}
+
+	return(true);
+}
+
+void MessageBus::Unsubscribe(int iTopic, void *pSubscriber)
+{
+	assert((iTopic >= 0) && (iTopic < MESSAGE_TOPIC_LAST));
+
+	std::lock_guard<std::mutex> sync(mutexTopics);
+	Topic *pTopic = &topics[iTopic];
+	unsigned uCount = pTopic->uCount.load(std::memory_order_relaxed);
+
+	for(unsigned i = 0; i < uCount; ++i)
+	{
+		Subscriber *pEntry = &pTopic->subscribers[i];
+
+		if(pEntry->bActive.load(std::memory_order_relaxed) && (pEntry->pContext == pSubscriber))
+		{
+			// a publish that marked the entry busy before this may still be
+			// delivering to it, one that marks it after sees it inactive
+
+			pEntry->bActive.store(false);
+
+			while(pEntry->uBusy.load() != 0)
+			{
+				sched_yield();
+			}
+		}
+	}
+}
+
+void MessageBus::Publish(int iTopic, const RobotMessage *pMessage)
+{
+	assert((iTopic >= 0) && (iTopic < MESSAGE_TOPIC_LAST));
+
+	Topic *pTopic = &topics[iTopic];
+	unsigned uCount = pTopic->uCount.load(std::memory_order_acquire);
+	long long llStart = RobotClock::NowUs();
+	unsigned uFanout;
+	unsigned uFanoutMax;
+
+	for(unsigned i = 0; i < uCount; ++i)
+	{
+		Subscriber *pSubscriber = &pTopic->subscribers[i];
+
+		// busy first, so Unsubscribe() either sees us or we see it
+
+		pSubscriber->uBusy.fetch_add(1);
+
+		if(pSubscriber->bActive.load())
+		{
+			if(pSubscriber->pQueue)
+			{
+				pSubscriber->pQueue->Send(pMessage);
+			}
+			else
+			{
+				pSubscriber->pCallback(pSubscriber->pContext, pMessage);
+			}
+		}
+
+		pSubscriber->uBusy.fetch_sub(1, std::memory_order_release);
+	}
+
+	uFanout = (unsigned)(RobotClock::NowUs() - llStart);
+
+	pTopic->uPublishes.fetch_add(1, std::memory_order_relaxed);
+	pTopic->ullFanoutTotalUs.fetch_add(uFanout, std::memory_order_relaxed);
+	uFanoutMax = pTopic->uFanoutMaxUs.load(std::memory_order_relaxed);
+
+	while((uFanout > uFanoutMax) &&
+			!pTopic->uFanoutMaxUs.compare_exchange_weak(uFanoutMax, uFanout, std::memory_order_relaxed))
+	{
+		// intentionally empty
+	}
+}
+
+void MessageBus::GetTopicStats(int iTopic, MessageTopicStats &stats)
+{
+	assert((iTopic >= 0) && (iTopic < MESSAGE_TOPIC_LAST));
+
+	Topic *pTopic = &topics[iTopic];
+	unsigned uCount = pTopic->uCount.load(std::memory_order_acquire);
+
+	stats.uSubscribers = 0;
+
+	for(unsigned i = 0; i < uCount; ++i)
+	{
+		if(pTopic->subscribers[i].bActive.load(std::memory_order_relaxed))
+		{
+			stats.uSubscribers++;
+		}
+	}
+
+	stats.uPublishes = pTopic->uPublishes.load(std::memory_order_relaxed);
+	stats.uFanoutMaxUs = pTopic->uFanoutMaxUs.load(std::memory_order_relaxed);
+	stats.fFanoutAvgUs = stats.uPublishes ?
+			(float)pTopic->ullFanoutTotalUs.load(std::memory_order_relaxed) / stats.uPublishes : 0.0;
+}
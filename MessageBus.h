@@ -0,0 +1,86 @@
+/** \file
+ * Topic based publish/subscribe on top of the component mailboxes.
+ *
+ * Some messages are broadcasts, like robot state changes or the battery
+ * voltage, and the sender should not have to know everyone who cares.  Tasks
+ * subscribe to a topic either with their MessageQueue, in which case every
+ * publish drops a copy of the message in their mailbox, or with a callback that
+ * runs in the publisher's thread.  Callbacks must be short and must not block,
+ * they are meant for helper threads like CheezyLoop that have no mailbox.
+ *
+ * Publishing walks a fixed table of subscribers without taking a lock and
+ * makes no system calls unless a receiver has to be woken up.  Subscribing
+ * takes a lock and is expected to happen while the robot is being built.
+ * Unsubscribing frees the entry for the next subscriber and only returns once
+ * no publish is still delivering to it, so an object may unsubscribe in its
+ * destructor.  It must not be called from a callback on the same topic.
+ */
+
+#ifndef MESSAGE_BUS_H
+#define MESSAGE_BUS_H
+
+#include <atomic>
+#include <mutex>
+
+//Robot
+#include <RobotMessage.h>
+#include <MessageQueue.h>
+
+///number of subscribers a single topic can have
+const unsigned MESSAGE_BUS_MAX_SUBSCRIBERS = 16;
+
+///broadcast topics
+typedef enum MESSAGE_TOPICS
+{
+	MESSAGE_TOPIC_ROBOT_STATE,		//!< COMMAND_ROBOT_STATE_*
+	MESSAGE_TOPIC_SYSTEM,			//!< battery voltage and other system constants
+	MESSAGE_TOPIC_AUTONOMOUS,		//!< autonomous script started or finished
+	MESSAGE_TOPIC_DIAGNOSTICS,		//!< requests to dump traces and other debug data
+	MESSAGE_TOPIC_LAST
+} MESSAGE_TOPICS;
+
+///called in the publisher's thread for every message on a topic
+typedef void (*MessageCallback)(void *pContext, const RobotMessage *pMessage);
+
+///snapshot of how a topic has been used
+struct MessageTopicStats {
+	unsigned uSubscribers;			//!< active subscribers
+	unsigned uPublishes;			//!< messages published
+	float fFanoutAvgUs;				//!< average time to deliver to every subscriber
+	unsigned uFanoutMaxUs;			//!< longest time to deliver to every subscriber
+};
+
+class MessageBus
+{
+public:
+	static bool Subscribe(int iTopic, MessageQueue *pQueue);
+	static bool Subscribe(int iTopic, MessageCallback pCallback, void *pContext);
+	static void Unsubscribe(int iTopic, void *pSubscriber);
+
+	static void Publish(int iTopic, const RobotMessage *pMessage);
+	static void GetTopicStats(int iTopic, MessageTopicStats &stats);
+
+private:
+	struct Subscriber {
+		MessageQueue *pQueue;
+		MessageCallback pCallback;
+		void *pContext;
+		std::atomic<bool> bActive;
+		std::atomic<unsigned> uBusy;	//publishes delivering to this entry right now
+	};
+
+	struct Topic {
+		Subscriber subscribers[MESSAGE_BUS_MAX_SUBSCRIBERS];
+		std::atomic<unsigned> uCount;
+		std::atomic<unsigned> uPublishes;
+		std::atomic<unsigned long long> ullFanoutTotalUs;
+		std::atomic<unsigned> uFanoutMaxUs;
+	};
+
+	static std::mutex mutexTopics;
+	static Topic topics[MESSAGE_TOPIC_LAST];
+
+	static bool AddSubscriber(int iTopic, MessageQueue *pQueue, MessageCallback pCallback, void *pContext);
+};
+
+#endif //MESSAGE_BUS_H
@@ -0,0 +1,810 @@
+/** \file
+ * In-process mailbox used to pass RobotMessages between tasks.
+ *
+ * The ring buffer follows the well known bounded queue design where every cell
+ * carries a sequence number.  A producer claims a cell by advancing the enqueue
+ * position, copies the message in and then publishes it by bumping the cell's
+ * sequence.  The dequeue side works the same way.  There is only one receiver
+ * per queue, but a sender dropping the oldest message to make room has to be
+ * able to take a cell too, so the dequeue position is claimed the same way.
+ *
+ * Each priority lane is one of these rings.  Every cell also records when it
+ * was queued so the receiver can keep track of how long messages wait.
+ *
+ * The latest-value slots are seqlocks.  A sender makes the version odd, copies
+ * the message and makes it even again.  The receiver copies the message out and
+ * retries if the version moved underneath it.  Nobody waits for a sender that
+ * is part way through, it may have been preempted by the very thread that
+ * would wait at a higher priority.  The receiver leaves the slot for the wake
+ * up that sender sends when it is done, and a second sender loses its value
+ * and counts it like any other overwrite.
+ * Each lane has one more of these for MESSAGE_OVERFLOW_OVERWRITE.  While it
+ * holds something every later send to the lane goes there too, so nothing
+ * sent after it can overtake it through the ring.
+ */
+
+#include <assert.h>
+#include <poll.h>
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <MessageQueue.h>
+#include <RobotClock.h>
+
+std::mutex MessageQueue::mutexRegistry;
+std::vector<MessageQueue *> MessageQueue::registry;
+MessageQueue::Endpoint MessageQueue::endpoints[MESSAGE_ENDPOINT_CACHE_SIZE];
+std::atomic<unsigned> MessageQueue::uEndpointCount(0);
+std::atomic<unsigned> MessageQueue::uEndpointLookups(0);
+std::atomic<unsigned> MessageQueue::uEndpointOpens(0);
+std::atomic<bool> MessageQueue::bTracing(false);
+std::atomic<unsigned> MessageQueue::uTraceSequence(0);
+thread_local unsigned MessageQueue::uTraceSource = 0;
+std::atomic<MessageTap> MessageQueue::pTap(NULL);
+
+long long MessageQueue::GetTraceTimeUs()
+{
+	return(RobotClock::NowUs());
+}
+
+MessageQueue::MessageQueue(const char *szQueueName, unsigned uQueueDepth, unsigned uHighQueueDepth)
+{
+	queueName = szQueueName;
+
+	InitLane(&lanes[MESSAGE_LANE_HIGH], uHighQueueDepth);
+	InitLane(&lanes[MESSAGE_LANE_NORMAL], uQueueDepth);
+	bReceiverWaiting.store(false);
+
+	for(int i = 0; i < MESSAGE_SLOT_LAST; ++i)
+	{
+		slots[i].uVersion.store(0, std::memory_order_relaxed);
+		slots[i].uDelivered.store(0, std::memory_order_relaxed);
+	}
+
+	uSlotOverwrites.store(0, std::memory_order_relaxed);
+	uFolded.store(0, std::memory_order_relaxed);
+
+	iEventFd = eventfd(0, EFD_NONBLOCK);
+	assert(iEventFd >= 0);
+
+	std::lock_guard<std::mutex> sync(mutexRegistry);
+	registry.push_back(this);
+}
+
+MessageQueue::~MessageQueue()
+{
+	{
+		std::lock_guard<std::mutex> sync(mutexRegistry);
+		std::vector<MessageQueue *>::iterator nextQueue = registry.begin();
+
+		for(; nextQueue != registry.end(); ++nextQueue)
+		{
+			if(*nextQueue == this)
+			{
+				registry.erase(nextQueue);
+				break;
+			}
+		}
+
+		// forget any cached handle, GetEndpoint() will look the name up again
+
+		for(unsigned i = 0; i < uEndpointCount.load(std::memory_order_relaxed); ++i)
+		{
+			if(endpoints[i].pQueue.load(std::memory_order_relaxed) == this)
+			{
+				endpoints[i].pQueue.store(NULL, std::memory_order_release);
+			}
+		}
+	}
+
+	close(iEventFd);
+
+	for(int i = 0; i < MESSAGE_LANE_LAST; ++i)
+	{
+		delete[] lanes[i].pCells;
+	}
+}
+
+void MessageQueue::InitLane(Lane *pLane, unsigned uLaneDepth)
+{
+	// the index math below needs a power of two
+
+	assert(uLaneDepth && ((uLaneDepth & (uLaneDepth - 1)) == 0));
+
+	pLane->uMask = uLaneDepth - 1;
+	pLane->pCells = new Cell[uLaneDepth];
+
+	for(unsigned i = 0; i < uLaneDepth; ++i)
+	{
+		pLane->pCells[i].uSequence.store(i, std::memory_order_relaxed);
+	}
+
+	pLane->uEnqueuePos.store(0, std::memory_order_relaxed);
+	pLane->uDequeuePos.store(0, std::memory_order_relaxed);
+	pLane->iOverflow.store(MESSAGE_OVERFLOW_BLOCK, std::memory_order_relaxed);
+	pLane->overflow.uVersion.store(0, std::memory_order_relaxed);
+	pLane->overflow.uDelivered.store(0, std::memory_order_relaxed);
+	pLane->uOverflows.store(0, std::memory_order_relaxed);
+	pLane->uDropped.store(0, std::memory_order_relaxed);
+	pLane->uHighWater.store(0, std::memory_order_relaxed);
+	pLane->uDelivered.store(0, std::memory_order_relaxed);
+	pLane->ullWaitTotalUs.store(0, std::memory_order_relaxed);
+	pLane->uWaitMaxUs.store(0, std::memory_order_relaxed);
+}
+
+void MessageQueue::GetLaneStats(int iLane, MessageLaneStats &stats)
+{
+	Lane *pLane = &lanes[iLane];
+	unsigned uEnqueued = pLane->uEnqueuePos.load(std::memory_order_relaxed);
+
+	stats.uDelivered = pLane->uDelivered.load(std::memory_order_relaxed);
+	stats.uDepth = uEnqueued - pLane->uDequeuePos.load(std::memory_order_relaxed);
+	stats.uHighWater = pLane->uHighWater.load(std::memory_order_relaxed);
+	stats.uWaitMaxUs = pLane->uWaitMaxUs.load(std::memory_order_relaxed);
+	stats.fWaitAvgUs = stats.uDelivered ?
+			(float)pLane->ullWaitTotalUs.load(std::memory_order_relaxed) / stats.uDelivered : 0.0;
+	stats.iOverflow = pLane->iOverflow.load(std::memory_order_relaxed);
+	stats.uOverflows = pLane->uOverflows.load(std::memory_order_relaxed);
+	stats.uDropped = pLane->uDropped.load(std::memory_order_relaxed);
+}
+
+void MessageQueue::SetOverflow(int iLane, int iOverflow)
+{
+	assert((iLane >= 0) && (iLane < MESSAGE_LANE_LAST));
+	assert((iOverflow >= 0) && (iOverflow < MESSAGE_OVERFLOW_LAST));
+
+	lanes[iLane].iOverflow.store(iOverflow, std::memory_order_relaxed);
+}
+
+int MessageQueue::GetLane(MessageCommand command)
+{
+	switch(command)
+	{
+		case COMMAND_ROBOT_STATE_DISABLED:
+		case COMMAND_ROBOT_STATE_AUTONOMOUS:
+		case COMMAND_ROBOT_STATE_TELEOPERATED:
+		case COMMAND_ROBOT_STATE_TEST:
+		case COMMAND_ROBOT_STATE_UNKNOWN:
+		case COMMAND_AUTONOMOUS_RESPONSE_OK:
+		case COMMAND_AUTONOMOUS_RESPONSE_ERROR:
+			return(MESSAGE_LANE_HIGH);
+
+		default:
+			return(MESSAGE_LANE_NORMAL);
+	}
+}
+
+MessageQueue *MessageQueue::Open(const char *szQueueName)
+{
+	std::lock_guard<std::mutex> sync(mutexRegistry);
+
+	return(Find(szQueueName));
+}
+
+///the caller holds mutexRegistry
+MessageQueue *MessageQueue::Find(const char *szQueueName)
+{
+	std::vector<MessageQueue *>::iterator nextQueue = registry.begin();
+
+	for(; nextQueue != registry.end(); ++nextQueue)
+	{
+		if(!strcmp((*nextQueue)->queueName.c_str(), szQueueName))
+		{
+			return(*nextQueue);
+		}
+	}
+
+	return(NULL);
+}
+
+MessageQueue *MessageQueue::GetEndpoint(const char *szQueueName)
+{
+	MessageQueue *pQueue;
+	unsigned uCount = uEndpointCount.load(std::memory_order_acquire);
+
+	uEndpointLookups.fetch_add(1, std::memory_order_relaxed);
+
+	// queue names are constants so comparing the pointers is enough almost
+	// every time, entries are never removed so no lock is needed to look
+
+	for(unsigned i = 0; i < uCount; ++i)
+	{
+		if(endpoints[i].szQueueName == szQueueName)
+		{
+			pQueue = endpoints[i].pQueue.load(std::memory_order_acquire);
+
+			if(pQueue)
+			{
+				return(pQueue);
+			}
+
+			break;
+		}
+	}
+
+	// first time we have seen this name, or its queue went away.  Look it up
+	// and remember it under the same lock so a queue being destroyed can not
+	// slip in between and leave a dangling handle behind.
+
+	std::lock_guard<std::mutex> sync(mutexRegistry);
+
+	pQueue = Find(szQueueName);
+	uEndpointOpens.fetch_add(1, std::memory_order_relaxed);
+
+	if(pQueue)
+	{
+		uCount = uEndpointCount.load(std::memory_order_relaxed);
+
+		for(unsigned i = 0; i < uCount; ++i)
+		{
+			if(endpoints[i].szQueueName == szQueueName)
+			{
+				endpoints[i].pQueue.store(pQueue, std::memory_order_release);
+				return(pQueue);
+			}
+		}
+
+		if(uCount < MESSAGE_ENDPOINT_CACHE_SIZE)
+		{
+			endpoints[uCount].szQueueName = szQueueName;
+			endpoints[uCount].pQueue.store(pQueue, std::memory_order_relaxed);
+			uEndpointCount.store(uCount + 1, std::memory_order_release);
+		}
+	}
+
+	return(pQueue);
+}
+
+void MessageQueue::GetEndpointStats(unsigned &uLookups, unsigned &uOpens)
+{
+	uLookups = uEndpointLookups.load(std::memory_order_relaxed);
+	uOpens = uEndpointOpens.load(std::memory_order_relaxed);
+}
+
+bool MessageQueue::TrySend(Lane *pLane, const RobotMessage *pMessage)
+{
+	Cell *pCell;
+	unsigned uPos = pLane->uEnqueuePos.load(std::memory_order_relaxed);
+	unsigned uDepth;
+	unsigned uHighWater;
+
+	while(true)
+	{
+		pCell = &pLane->pCells[uPos & pLane->uMask];
+		unsigned uSequence = pCell->uSequence.load(std::memory_order_acquire);
+		int iDiff = (int)uSequence - (int)uPos;
+
+		if(iDiff == 0)
+		{
+			// the cell is free, try to claim it
+
+			if(pLane->uEnqueuePos.compare_exchange_weak(uPos, uPos + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if(iDiff < 0)
+		{
+			// the receiver has not caught up, we are full
+
+			return(false);
+		}
+		else
+		{
+			// someone else got here first
+
+			uPos = pLane->uEnqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	pCell->llQueuedUs = RobotClock::NowUs();
+	CopyMessage(&pCell->message, pMessage);
+	pCell->uSequence.store(uPos + 1, std::memory_order_release);
+
+	// keep track of the deepest the lane has been
+
+	uDepth = uPos + 1 - pLane->uDequeuePos.load(std::memory_order_relaxed);
+	uHighWater = pLane->uHighWater.load(std::memory_order_relaxed);
+
+	while((uDepth > uHighWater) &&
+			!pLane->uHighWater.compare_exchange_weak(uHighWater, uDepth, std::memory_order_relaxed))
+	{
+		// intentionally empty
+	}
+
+	return(true);
+}
+
+int MessageQueue::GetSlot(MessageCommand command)
+{
+	switch(command)
+	{
+		case COMMAND_DRIVETRAIN_DRIVE_CHEEZY:
+		case COMMAND_DRIVETRAIN_DRIVE_TANK:
+		case COMMAND_DRIVETRAIN_DRIVE_SPLITARCADE:
+			return(MESSAGE_SLOT_DRIVE);
+
+		case COMMAND_SYSTEM_CONSTANTS:
+			return(MESSAGE_SLOT_CONSTANTS);
+
+		default:
+			return(-1);
+	}
+}
+
+bool MessageQueue::IsFoldable(MessageCommand command)
+{
+	// only the newest of these matters, an older copy waiting behind it
+	// would just undo it for a moment
+
+	switch(command)
+	{
+		case COMMAND_DRIVETRAIN_DRIVE_CHEEZY:
+		case COMMAND_DRIVETRAIN_DRIVE_TANK:
+		case COMMAND_DRIVETRAIN_DRIVE_SPLITARCADE:
+		case COMMAND_DRIVETRAIN_AUTO_MOVE:
+		case COMMAND_SYSTEM_CONSTANTS:
+		case COMMAND_SYSTEM_TRACE_DUMP:
+			return(true);
+
+		default:
+			return(false);
+	}
+}
+
+bool MessageQueue::WriteSlot(Slot *pSlot, const RobotMessage *pMessage)
+{
+	unsigned uVersion = pSlot->uVersion.load(std::memory_order_relaxed);
+	bool bReplaced;
+
+	// claim the slot by making the version odd, senders almost never collide
+
+	do
+	{
+		if(uVersion & 1)
+		{
+			// another sender is writing, and may stay preempted there for as
+			// long as we would spin.  Its value is as fresh as ours, lose this one
+
+			return(true);
+		}
+	} while(!pSlot->uVersion.compare_exchange_strong(uVersion, uVersion + 1, std::memory_order_acquire));
+
+	// was the last value never picked up?
+
+	bReplaced = (uVersion != pSlot->uDelivered.load(std::memory_order_relaxed));
+
+	std::atomic_thread_fence(std::memory_order_release);
+	CopyMessage(&pSlot->message, pMessage);
+	pSlot->uVersion.store(uVersion + 2, std::memory_order_release);
+	return(bReplaced);
+}
+
+bool MessageQueue::ReadSlot(Slot *pSlot, RobotMessage *pMessage)
+{
+	unsigned uVersion = pSlot->uVersion.load(std::memory_order_acquire);
+
+	while(uVersion != pSlot->uDelivered.load(std::memory_order_relaxed))
+	{
+		if(uVersion & 1)
+		{
+			// a sender is in the middle of it, it wakes us when it is done
+
+			return(false);
+		}
+
+		CopyMessage(pMessage, &pSlot->message);
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if(pSlot->uVersion.load(std::memory_order_relaxed) == uVersion)
+		{
+			pSlot->uDelivered.store(uVersion, std::memory_order_relaxed);
+			return(true);
+		}
+
+		uVersion = pSlot->uVersion.load(std::memory_order_acquire);
+	}
+
+	return(false);
+}
+
+bool MessageQueue::ReadSlots(RobotMessage *pMessage)
+{
+	for(int i = 0; i < MESSAGE_SLOT_LAST; ++i)
+	{
+		if(ReadSlot(&slots[i], pMessage))
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+void MessageQueue::Send(const RobotMessage *pMessage)
+{
+	unsigned uRetries = 0;
+	int iSlot = GetSlot(pMessage->command);
+	Lane *pLane = &lanes[GetLane(pMessage->command)];
+	int iOverflow = pLane->iOverflow.load(std::memory_order_relaxed);
+	RobotMessage tracedMessage;
+	MessageTap pSendTap = pTap.load(std::memory_order_acquire);
+	bool bDropped = false;
+
+	if(bTracing.load(std::memory_order_relaxed))
+	{
+		// stamp a copy, the caller's message is const and often reused
+
+		CopyMessage(&tracedMessage, pMessage);
+		tracedMessage.trace.llSentUs = RobotClock::NowUs();
+		tracedMessage.trace.uSequence = uTraceSequence.fetch_add(1, std::memory_order_relaxed);
+		tracedMessage.trace.uSource = uTraceSource;
+		pMessage = &tracedMessage;
+	}
+
+	if(iSlot >= 0)
+	{
+		// continuous command, only the latest value matters
+
+		if(WriteSlot(&slots[iSlot], pMessage))
+		{
+			uSlotOverwrites.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		if(pSendTap)
+		{
+			pSendTap(this, pMessage, false);
+		}
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if(bReceiverWaiting.load(std::memory_order_relaxed))
+		{
+			WakeReceiver();
+		}
+
+		return;
+	}
+
+	if((iOverflow == MESSAGE_OVERFLOW_OVERWRITE) &&
+			(pLane->overflow.uVersion.load(std::memory_order_acquire) !=
+			pLane->overflow.uDelivered.load(std::memory_order_relaxed)))
+	{
+		// something is already parked, queueing behind it keeps the order
+
+		pLane->uOverflows.fetch_add(1, std::memory_order_relaxed);
+		Overflow(pLane, pMessage);
+	}
+	else if(!TrySend(pLane, pMessage))
+	{
+		pLane->uOverflows.fetch_add(1, std::memory_order_relaxed);
+
+		switch(iOverflow)
+		{
+			case MESSAGE_OVERFLOW_DROP_NEWEST:
+				pLane->uDropped.fetch_add(1, std::memory_order_relaxed);
+				bDropped = true;
+				break;
+
+			case MESSAGE_OVERFLOW_DROP_OLDEST:
+				// another sender may take the room we made, so try again, but
+				// the oldest cell may be claimed by a sender that was preempted
+				// before publishing it.  Do not spin on it, drop this one instead
+
+				do
+				{
+					if(++uRetries > MESSAGE_QUEUE_DROP_RETRIES)
+					{
+						pLane->uDropped.fetch_add(1, std::memory_order_relaxed);
+						bDropped = true;
+						break;
+					}
+
+					if(Dequeue(pLane, NULL, NULL))
+					{
+						pLane->uDropped.fetch_add(1, std::memory_order_relaxed);
+					}
+				} while(!TrySend(pLane, pMessage));
+				break;
+
+			case MESSAGE_OVERFLOW_OVERWRITE:
+				Overflow(pLane, pMessage);
+				break;
+
+			default:
+				// a full pipe used to block the writer, do the same here.  Give
+				// the receiver a chance to run before backing off for real.
+
+				do
+				{
+					WakeReceiver();
+
+					if(++uRetries < MESSAGE_QUEUE_FULL_YIELDS)
+					{
+						sched_yield();
+					}
+					else
+					{
+						usleep(MESSAGE_QUEUE_FULL_BACKOFF);
+					}
+				} while(!TrySend(pLane, pMessage));
+				break;
+		}
+	}
+
+	// the tap learns what became of the message, so a log of it only replays
+	// what the receiver really got
+
+	if(pSendTap)
+	{
+		pSendTap(this, pMessage, bDropped);
+	}
+
+	// only pay for the system call if the receiver is asleep
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if(bReceiverWaiting.load(std::memory_order_relaxed))
+	{
+		WakeReceiver();
+	}
+}
+
+void MessageQueue::WakeReceiver()
+{
+	uint64_t uCount = 1;
+
+	write(iEventFd, &uCount, sizeof(uCount));
+}
+
+void MessageQueue::Overflow(Lane *pLane, const RobotMessage *pMessage)
+{
+	if(WriteSlot(&pLane->overflow, pMessage))
+	{
+		pLane->uDropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+bool MessageQueue::Dequeue(Lane *pLane, RobotMessage *pMessage, long long *pllQueuedUs)
+{
+	Cell *pCell;
+	unsigned uPos = pLane->uDequeuePos.load(std::memory_order_relaxed);
+
+	while(true)
+	{
+		pCell = &pLane->pCells[uPos & pLane->uMask];
+		unsigned uSequence = pCell->uSequence.load(std::memory_order_acquire);
+		int iDiff = (int)uSequence - (int)(uPos + 1);
+
+		if(iDiff == 0)
+		{
+			// published and not yet taken, try to claim it
+
+			if(pLane->uDequeuePos.compare_exchange_weak(uPos, uPos + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if(iDiff < 0)
+		{
+			// nothing published yet
+
+			return(false);
+		}
+		else
+		{
+			// a sender dropping the oldest got here first
+
+			uPos = pLane->uDequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	// a sender making room does not care what it threw away
+
+	if(pMessage)
+	{
+		CopyMessage(pMessage, &pCell->message);
+		*pllQueuedUs = pCell->llQueuedUs;
+	}
+
+	pCell->uSequence.store(uPos + pLane->uMask + 1, std::memory_order_release);
+	return(true);
+}
+
+bool MessageQueue::TryReceiveLane(Lane *pLane, RobotMessage *pMessage)
+{
+	long long llQueuedUs;
+	unsigned uWait;
+	unsigned uWaitMax;
+
+	if(!Dequeue(pLane, pMessage, &llQueuedUs))
+	{
+		// the ring is empty, anything parked on overflow is newer than all of it
+
+		if(ReadSlot(&pLane->overflow, pMessage))
+		{
+			pLane->uDelivered.fetch_add(1, std::memory_order_relaxed);
+			return(true);
+		}
+
+		return(false);
+	}
+
+	uWait = (unsigned)(RobotClock::NowUs() - llQueuedUs);
+
+	// only the receiver writes these, the atomics are for whoever reads the stats
+
+	pLane->uDelivered.store(pLane->uDelivered.load(std::memory_order_relaxed) + 1,
+			std::memory_order_relaxed);
+	pLane->ullWaitTotalUs.store(pLane->ullWaitTotalUs.load(std::memory_order_relaxed) + uWait,
+			std::memory_order_relaxed);
+	uWaitMax = pLane->uWaitMaxUs.load(std::memory_order_relaxed);
+
+	if(uWait > uWaitMax)
+	{
+		pLane->uWaitMaxUs.store(uWait, std::memory_order_relaxed);
+	}
+
+	return(true);
+}
+
+bool MessageQueue::TryReceive(RobotMessage *pMessage)
+{
+	// most urgent first, then the bulk traffic, then fresh continuous values
+
+	for(int i = 0; i < MESSAGE_LANE_LAST; ++i)
+	{
+		if(TryReceiveLane(&lanes[i], pMessage))
+		{
+			return(true);
+		}
+	}
+
+	return(ReadSlots(pMessage));
+}
+
+bool MessageQueue::Receive(RobotMessage *pMessage, int iTimeoutUs)
+{
+	struct pollfd pollSet;
+	long long llDeadline;
+	long long llNow;
+	uint64_t uCount;
+
+	if(TryReceive(pMessage))
+	{
+		return(true);
+	}
+
+	llNow = RobotClock::NowUs();
+	llDeadline = llNow + iTimeoutUs;
+
+	pollSet.fd = iEventFd;
+	pollSet.events = POLLIN;
+
+	while(llNow < llDeadline)
+	{
+		// tell the senders we are going to sleep, then look once more so
+		// a message published in between is not missed
+
+		bReceiverWaiting.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if(TryReceive(pMessage))
+		{
+			bReceiverWaiting.store(false, std::memory_order_relaxed);
+			return(true);
+		}
+
+		poll(&pollSet, 1, (int)((RobotClock::RealUs(llDeadline - llNow) + 999) / 1000));
+		bReceiverWaiting.store(false, std::memory_order_relaxed);
+		read(iEventFd, &uCount, sizeof(uCount));
+
+		if(TryReceive(pMessage))
+		{
+			return(true);
+		}
+
+		llNow = RobotClock::NowUs();
+	}
+
+	return(false);
+}
+
+unsigned MessageQueue::ReceiveBatch(RobotMessage *pBatch, unsigned uMax, int iTimeoutUs, bool *pbFull)
+{
+	unsigned uCount = 0;
+
+	if(pbFull)
+	{
+		*pbFull = false;
+	}
+
+	// wait for the first one like Receive(), then take whatever else is
+	// already there without waiting again
+
+	if((uMax == 0) || !Receive(&pBatch[uCount++], iTimeoutUs))
+	{
+		return(0);
+	}
+
+	for(int i = 0; i < MESSAGE_LANE_LAST; ++i)
+	{
+		while((uCount < uMax) && TryReceiveLane(&lanes[i], &pBatch[uCount]))
+		{
+			uCount++;
+		}
+	}
+
+	while((uCount < uMax) && ReadSlots(&pBatch[uCount]))
+	{
+		uCount++;
+	}
+
+	// folding can leave a full batch short, more may still be waiting
+
+	if(pbFull)
+	{
+		*pbFull = (uCount == uMax);
+	}
+
+	return(Fold(pBatch, uCount));
+}
+
+unsigned MessageQueue::Fold(RobotMessage *pBatch, unsigned uCount)
+{
+	bool bNewer[COMMAND_LAST] = { false };
+	unsigned uFoldedCount = uCount;
+
+	// walk backwards so the newest copy of each foldable command is the one
+	// kept, then close the gaps so everything else stays in order.  Every
+	// message kept is packed in below uFoldedCount, which is then left
+	// holding the number folded away
+
+	for(unsigned i = uCount; i-- > 0; )
+	{
+		MessageCommand command = pBatch[i].command;
+
+		if(((unsigned)command < (unsigned)COMMAND_LAST) && IsFoldable(command))
+		{
+			if(bNewer[command])
+			{
+				continue;
+			}
+
+			bNewer[command] = true;
+		}
+
+		if(--uFoldedCount != i)
+		{
+			CopyMessage(&pBatch[uFoldedCount], &pBatch[i]);
+		}
+	}
+
+	if(uFoldedCount > 0)
+	{
+		for(unsigned i = uFoldedCount; i < uCount; ++i)
+		{
+			CopyMessage(&pBatch[i - uFoldedCount], &pBatch[i]);
+		}
+
+		uFolded.fetch_add(uFoldedCount, std::memory_order_relaxed);
+	}
+
+	return(uCount - uFoldedCount);
+}
+
+void MessageQueue::Clear()
+{
+	RobotMessage eatMessage;
+
+	// eat all the messages in the queue
+
+	while(TryReceive(&eatMessage))
+	{
+		// intentionally empty
+	}
+}
@@ -0,0 +1,233 @@
+/** \file
+ * In-process mailbox used to pass RobotMessages between tasks.
+ *
+ * All of our components live in the same process, so there is no reason to
+ * push every message through the kernel.  Each component owns a MessageQueue,
+ * a bounded multiple producer / single consumer ring buffer.  Senders copy the
+ * message into a free cell and never make a system call unless the receiver is
+ * asleep, in which case an eventfd is used to wake it up.
+ *
+ * Continuous commands, like the joystick readings sent to Drivetrain every
+ * driver station packet, do not go into the ring at all.  Each one has a
+ * latest-value slot that a new message simply overwrites, so a receiver that
+ * was stuck in a long handler acts on the freshest input instead of replaying
+ * seconds of stale stick positions.  Discrete commands stay queued in order.
+ *
+ * Only the part of the parameters a command actually uses is copied in and
+ * out, see CommandTraits.h.
+ *
+ * Discrete commands are split into two priority lanes.  State changes and
+ * autonomous responses go in the high lane and are always delivered before
+ * anything in the normal lane, so they never wait behind bulk teleop traffic.
+ * That means they can overtake commands sent earlier.  Stops stay in the
+ * normal lane so they are acted on after the moves queued ahead of them, and
+ * receivers must not let a move that arrives after a state change undo it.
+ *
+ * What happens when a lane is full is up to each queue, see MESSAGE_OVERFLOW.
+ * Only MESSAGE_OVERFLOW_BLOCK makes the sender wait, the others lose a message
+ * and count it, so a slow receiver can not stall the driver station loop.
+ *
+ * ReceiveBatch() takes everything waiting in one pass and folds continuous
+ * commands that a newer copy in the same batch supersedes, so a component
+ * that was stuck in a long handler catches up in one go instead of working
+ * through the backlog one message per loop.  Folding can leave a full batch
+ * short, so a receiver draining a backlog asks ReceiveBatch() whether it
+ * filled the batch rather than comparing the count.
+ *
+ * When tracing is turned on every message is stamped on its way in with the
+ * send time, a global sequence number and the id of the sending task, so the
+ * receiver can tell how long it sat before anyone acted on it.
+ *
+ * A single tap, see SetTap(), sees every message sent to any queue, after the
+ * overflow policy, along with whether the policy dropped it.  The flight log
+ * uses it to record matches.
+ *
+ * Queues register themselves by name so code that only knows a queue name
+ * (like RobotMessage::replyQ) can still find the mailbox.  Senders should use
+ * GetEndpoint(), which looks each name up once and then hands back the cached
+ * handle without taking a lock.  A queue that is destroyed clears its cached
+ * handles, so the next GetEndpoint() looks the name up again, but senders must
+ * still stop using a queue before its owner deletes it.
+ */
+
+#ifndef MESSAGE_QUEUE_H
+#define MESSAGE_QUEUE_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Robot
+#include <RobotMessage.h>
+#include <CommandTraits.h>
+
+///number of messages the normal lane can hold, must be a power of two
+const unsigned MESSAGE_QUEUE_DEPTH = 128;
+
+///number of messages the high priority lane can hold, must be a power of two
+const unsigned MESSAGE_QUEUE_HIGH_DEPTH = 32;
+
+///what Send() does when the lane a message belongs in is full
+typedef enum MESSAGE_OVERFLOW
+{
+	MESSAGE_OVERFLOW_BLOCK,			//!< wait for the receiver to make room, like a pipe would
+	MESSAGE_OVERFLOW_DROP_OLDEST,	//!< throw away the oldest queued message to make room, this one if that fails
+	MESSAGE_OVERFLOW_DROP_NEWEST,	//!< throw away the message being sent
+	MESSAGE_OVERFLOW_OVERWRITE,		//!< park it in the lane's overflow slot, replacing what is there
+	MESSAGE_OVERFLOW_LAST
+} MESSAGE_OVERFLOW;
+
+///how many times a sender yields to the receiver when the mailbox is full
+const unsigned MESSAGE_QUEUE_FULL_YIELDS = 16;
+
+///how long a sender then backs off when the mailbox is still full (microseconds)
+const unsigned MESSAGE_QUEUE_FULL_BACKOFF = 100;
+
+///how many times a MESSAGE_OVERFLOW_DROP_OLDEST sender makes room before it drops its own message
+const unsigned MESSAGE_QUEUE_DROP_RETRIES = 4;
+
+///most messages ReceiveBatch() hands back at once
+const unsigned MESSAGE_BATCH_SIZE = 32;
+
+///number of queue names the endpoint cache remembers
+const unsigned MESSAGE_ENDPOINT_CACHE_SIZE = 32;
+
+///groups of continuous commands where only the newest value matters
+typedef enum MESSAGE_SLOTS
+{
+	MESSAGE_SLOT_DRIVE,			//!< cheezy, tank and split arcade drive inputs
+	MESSAGE_SLOT_CONSTANTS,		//!< battery voltage and other system constants
+	MESSAGE_SLOT_LAST
+} MESSAGE_SLOTS;
+
+///delivery order of queued commands, the high lane is always drained first
+typedef enum MESSAGE_LANES
+{
+	MESSAGE_LANE_HIGH,			//!< state changes and autonomous responses
+	MESSAGE_LANE_NORMAL,		//!< everything else
+	MESSAGE_LANE_LAST
+} MESSAGE_LANES;
+
+class MessageQueue;
+
+///called in the sender's thread for every message sent to any queue, once the overflow policy
+///has dealt with it.  bDropped is true when the policy threw this message away
+typedef void (*MessageTap)(MessageQueue *pQueue, const RobotMessage *pMessage, bool bDropped);
+
+///snapshot of how busy a lane has been
+struct MessageLaneStats {
+	unsigned uDepth;			//!< messages waiting right now
+	unsigned uHighWater;		//!< most messages ever waiting at once
+	unsigned uDelivered;		//!< messages handed to the receiver
+	float fWaitAvgUs;			//!< average time a message sat in the lane
+	unsigned uWaitMaxUs;		//!< longest time a message sat in the lane
+	int iOverflow;				//!< MESSAGE_OVERFLOW policy
+	unsigned uOverflows;		//!< sends that found the lane full
+	unsigned uDropped;			//!< messages lost to the policy
+};
+
+class MessageQueue
+{
+public:
+	MessageQueue(const char *szQueueName, unsigned uQueueDepth = MESSAGE_QUEUE_DEPTH,
+			unsigned uHighQueueDepth = MESSAGE_QUEUE_HIGH_DEPTH);
+	~MessageQueue();
+
+	void Send(const RobotMessage *pMessage);
+	bool Receive(RobotMessage *pMessage, int iTimeoutUs);
+	bool TryReceive(RobotMessage *pMessage);
+	unsigned ReceiveBatch(RobotMessage *pBatch, unsigned uMax, int iTimeoutUs, bool *pbFull = NULL);
+	void Clear();
+
+	const char *GetName() { return(queueName.c_str()); };
+	unsigned GetSlotOverwrites() { return(uSlotOverwrites.load(std::memory_order_relaxed)); };
+	unsigned GetFolded() { return(uFolded.load(std::memory_order_relaxed)); };
+	void GetLaneStats(int iLane, MessageLaneStats &stats);
+	void SetOverflow(int iLane, int iOverflow);
+
+	static int GetLane(MessageCommand command);
+	static int GetSlot(MessageCommand command);
+	static bool IsFoldable(MessageCommand command);
+
+	static void SetTracing(bool bEnable) { bTracing.store(bEnable, std::memory_order_relaxed); };
+	static bool IsTracing() { return(bTracing.load(std::memory_order_relaxed)); };
+	static void SetTraceSource(unsigned uSource) { uTraceSource = uSource; };
+	static long long GetTraceTimeUs();
+
+	static void SetTap(MessageTap pNewTap) { pTap.store(pNewTap, std::memory_order_release); };
+
+	static MessageQueue *Open(const char *szQueueName);
+	static MessageQueue *GetEndpoint(const char *szQueueName);
+	static void GetEndpointStats(unsigned &uLookups, unsigned &uOpens);
+
+private:
+	///a seqlock, the version is odd while a sender is writing
+	struct Slot {
+		std::atomic<unsigned> uVersion;
+		std::atomic<unsigned> uDelivered;	// version the receiver has seen
+		RobotMessage message;
+	};
+
+	struct Endpoint {
+		const char *szQueueName;
+		std::atomic<MessageQueue *> pQueue;	// NULL once the queue is destroyed
+	};
+
+	struct Cell {
+		std::atomic<unsigned> uSequence;
+		long long llQueuedUs;
+		RobotMessage message;
+	};
+
+	///one bounded ring, senders only dequeue to drop the oldest message
+	struct Lane {
+		Cell *pCells;
+		unsigned uMask;
+		std::atomic<unsigned> uEnqueuePos;
+		std::atomic<unsigned> uDequeuePos;
+		std::atomic<int> iOverflow;
+		Slot overflow;						// MESSAGE_OVERFLOW_OVERWRITE parks messages here
+		std::atomic<unsigned> uOverflows;
+		std::atomic<unsigned> uDropped;
+		std::atomic<unsigned> uHighWater;
+		std::atomic<unsigned> uDelivered;
+		std::atomic<unsigned long long> ullWaitTotalUs;
+		std::atomic<unsigned> uWaitMaxUs;
+	};
+
+	std::string queueName;
+	int iEventFd;
+
+	Lane lanes[MESSAGE_LANE_LAST];
+	std::atomic<bool> bReceiverWaiting;
+	Slot slots[MESSAGE_SLOT_LAST];
+	std::atomic<unsigned> uSlotOverwrites;
+	std::atomic<unsigned> uFolded;			// superseded by a newer copy in the same batch
+
+	static std::mutex mutexRegistry;
+	static std::vector<MessageQueue *> registry;
+	static Endpoint endpoints[MESSAGE_ENDPOINT_CACHE_SIZE];
+	static std::atomic<unsigned> uEndpointCount;
+	static std::atomic<unsigned> uEndpointLookups;
+	static std::atomic<unsigned> uEndpointOpens;
+	static std::atomic<bool> bTracing;
+	static std::atomic<unsigned> uTraceSequence;
+	static thread_local unsigned uTraceSource;
+	static std::atomic<MessageTap> pTap;
+
+	static MessageQueue *Find(const char *szQueueName);
+
+	void InitLane(Lane *pLane, unsigned uLaneDepth);
+	bool TrySend(Lane *pLane, const RobotMessage *pMessage);
+	bool Dequeue(Lane *pLane, RobotMessage *pMessage, long long *pllQueuedUs);
+	bool TryReceiveLane(Lane *pLane, RobotMessage *pMessage);
+	void Overflow(Lane *pLane, const RobotMessage *pMessage);
+	bool WriteSlot(Slot *pSlot, const RobotMessage *pMessage);
+	bool ReadSlot(Slot *pSlot, RobotMessage *pMessage);
+	bool ReadSlots(RobotMessage *pMessage);
+	unsigned Fold(RobotMessage *pBatch, unsigned uCount);
+	void WakeReceiver();
+};
+
+#endif //MESSAGE_QUEUE_H
@@ -0,0 +1,87 @@
+/** \file
+ * Matches command responses to the requests that asked for them.
+ */
+
+#include <chrono>
+
+#include <PendingResponses.h>
+#include <RobotClock.h>
+
+PendingResponses::PendingResponses()
+{
+	uNextCorrelation = CORRELATION_NONE;
+	uCompletions = 0;
+	uUnmatched = 0;
+}
+
+std::future<MessageCommand> PendingResponses::Expect(RobotMessage *pMessage)
+{
+	std::lock_guard<std::mutex> sync(mutexPending);
+
+	// skip the "no response" id when the counter wraps
+
+	if(++uNextCorrelation == CORRELATION_NONE)
+	{
+		++uNextCorrelation;
+	}
+
+	pMessage->uCorrelation = uNextCorrelation;
+	return(pending[uNextCorrelation].get_future());
+}
+
+bool PendingResponses::Complete(const RobotMessage *pReply)
+{
+	std::lock_guard<std::mutex> sync(mutexPending);
+	std::map<unsigned, std::promise<MessageCommand> >::iterator it = pending.find(pReply->uCorrelation);
+
+	if(it == pending.end())
+	{
+		uUnmatched++;
+		return(false);
+	}
+
+	it->second.set_value(pReply->command);
+	pending.erase(it);
+	uCompletions++;
+	condCompleted.notify_all();
+	return(true);
+}
+
+void PendingResponses::Cancel(unsigned uCorrelation)
+{
+	std::lock_guard<std::mutex> sync(mutexPending);
+
+	// the future is abandoned, its promise goes with it
+
+	pending.erase(uCorrelation);
+}
+
+unsigned PendingResponses::GetPending()
+{
+	std::lock_guard<std::mutex> sync(mutexPending);
+
+	return((unsigned)pending.size());
+}
+
+unsigned PendingResponses::GetUnmatched()
+{
+	std::lock_guard<std::mutex> sync(mutexPending);
+
+	return(uUnmatched);
+}
+
+unsigned PendingResponses::GetCompletions()
+{
+	std::lock_guard<std::mutex> sync(mutexPending);
+
+	return(uCompletions);
+}
+
+/// sleeps until a reply beyond the first uSeen comes in, false if the deadline (RobotClock) passes first
+bool PendingResponses::WaitForCompletion(unsigned uSeen, long long llDeadlineUs)
+{
+	std::unique_lock<std::mutex> sync(mutexPending);
+	std::chrono::microseconds wait(RobotClock::RealUs(llDeadlineUs - RobotClock::NowUs()));
+
+	return(condCompleted.wait_for(sync, wait, [this, uSeen] { return(uCompletions != uSeen); }));
+}
@@ -0,0 +1,58 @@
+/** \file
+ * Matches command responses to the requests that asked for them.
+ *
+ * A request that wants an answer gets a correlation id stamped into it by
+ * Expect(), which hands back a future for the response.  The component
+ * copies the id into its reply (see ComponentBase::SendCommandResponse) and
+ * the receiver passes every reply it gets to Complete(), which fulfils the
+ * matching future.  The waiting task sleeps on the future with a timeout
+ * instead of spinning on a flag.
+ *
+ * A reply that shows up after its request gave up, or that carries an id
+ * nobody is waiting for, is counted and dropped so it can never be mistaken
+ * for the answer to a later request.
+ *
+ * Waiting on several requests at once, where any one of them may finish
+ * first, uses WaitForCompletion() to sleep until some reply comes in rather
+ * than polling each future in turn.
+ */
+
+#ifndef PENDING_RESPONSES_H
+#define PENDING_RESPONSES_H
+
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <mutex>
+
+//Robot
+#include <RobotMessage.h>
+
+///a request that is not waiting for an answer carries this id
+const unsigned CORRELATION_NONE = 0;
+
+class PendingResponses
+{
+public:
+	PendingResponses();
+
+	std::future<MessageCommand> Expect(RobotMessage *pMessage);
+	bool Complete(const RobotMessage *pReply);
+	void Cancel(unsigned uCorrelation);
+
+	unsigned GetCompletions();
+	bool WaitForCompletion(unsigned uSeen, long long llDeadlineUs);
+
+	unsigned GetPending();
+	unsigned GetUnmatched();
+
+private:
+	std::mutex mutexPending;
+	std::condition_variable condCompleted;
+	std::map<unsigned, std::promise<MessageCommand> > pending;
+	unsigned uNextCorrelation;
+	unsigned uCompletions;				// replies matched so far
+	unsigned uUnmatched;				// late or unknown replies dropped
+};
+
+#endif //PENDING_RESPONSES_H
@@ -0,0 +1,63 @@
+/** \file
+ * Fixed rate tick with absolute deadlines.
+ */
+
+#include <PeriodicTimer.h>
+#include <RobotClock.h>
+
+PeriodicTimer::PeriodicTimer(float fPeriod)
+{
+	this->fPeriod = fPeriod;
+	llPeriodUs = (long long)(fPeriod * 1000000.0);
+	uTicks = 0;
+	uOverruns = 0;
+	fJitterMax = 0.0;
+	fJitterAvg = 0.0;
+
+	Start();
+}
+
+long long PeriodicTimer::NowUs()
+{
+	return(RobotClock::NowUs());
+}
+
+void PeriodicTimer::Start()
+{
+	// the first deadline is one period from now
+
+	llNextTickUs = RobotClock::NowUs();
+}
+
+void PeriodicTimer::WaitForNextTick()
+{
+	long long llNowUs;
+	float fJitter;
+
+	llNextTickUs += llPeriodUs;
+	RobotClock::SleepUntilUs(llNextTickUs);
+
+	llNowUs = RobotClock::NowUs();
+	uTicks++;
+
+	fJitter = (float)(llNowUs - llNextTickUs);
+	fJitterAvg += (fJitter - fJitterAvg) * fJitterFilter;
+
+	if(fJitter > fJitterMax)
+	{
+		fJitterMax = fJitter;
+	}
+
+	// if we are more than a whole period late, count it and skip the
+	// ticks we missed rather than trying to catch up in a burst
+
+	if(fJitter >= (float)llPeriodUs)
+	{
+		uOverruns++;
+
+		while(llNextTickUs + llPeriodUs <= llNowUs)
+		{
+			llNextTickUs += llPeriodUs;
+		}
+	}
+}
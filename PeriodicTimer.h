@@ -0,0 +1,42 @@
+/** \file
+ * Fixed rate tick with absolute deadlines.
+ *
+ * Every deadline is the previous deadline plus the period, not "now" plus the
+ * period, so time spent doing the work does not make the tick drift.  How late
+ * each wake up was is kept as a filtered average and a worst case.  A tick that
+ * starts more than a whole period late counts as an overrun, and the ticks it
+ * missed are skipped rather than run back to back to catch up.
+ */
+
+#ifndef PERIODIC_TIMER_H
+#define PERIODIC_TIMER_H
+
+class PeriodicTimer
+{
+public:
+	PeriodicTimer(float fPeriod);
+
+	void Start();
+	void WaitForNextTick();
+
+	float GetPeriod() { return(fPeriod); };
+	unsigned GetTicks() { return(uTicks); };
+	unsigned GetOverruns() { return(uOverruns); };
+	float GetJitterMax() { return(fJitterMax); };
+	float GetJitterAvg() { return(fJitterAvg); };
+
+	static long long NowUs();			// RobotClock::NowUs()
+
+private:
+	const float fJitterFilter = 0.01;	// weight of the newest sample in the average
+
+	float fPeriod;						// seconds
+	long long llPeriodUs;
+	long long llNextTickUs;				// on the RobotClock
+	unsigned uTicks;
+	unsigned uOverruns;					// ticks that started a whole period late
+	float fJitterMax;					// microseconds late waking up, worst case
+	float fJitterAvg;					// microseconds late waking up, filtered
+};
+
+#endif //PERIODIC_TIMER_H
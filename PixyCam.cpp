@@ -6,24 +6,27 @@
  */
 
 #include <PixyCam.h>
+#include <RobotParams.h>
+#include <ThreadConfig.h>
 
-PixyCam::PixyCam() {
+PixyCam::PixyCam(bool bStartTask) {
 
 	bBlockFound = false;
 	fCentroid = 0.0;
+	ePixyComState = PIXYCOM_UNSYNCHED;
+	uBlockByteCount = 0;
 	 //led->Set(Relay::kOn);
 
-	pTask = new Task("tPixy", &PixyCam::Run, this);
+	pTask = bStartTask ? new Task(PIXY_TASKNAME, &PixyCam::Run, this) : NULL;
 }
 
 void PixyCam::Run(PixyCam *pInstance)
 {
 	 uint8_t uPixiData[2];
 	 uint16_t uPixiWord;
-	 uint16_t uBlockByteCount;
-	 PIXICOM_STATES ePixyComState = PIXYCOM_UNSYNCHED;
 	 SPI* pCamera;
 
+	ThreadConfig::Apply(PIXY_TASKNAME, PIXY_PRIORITY);
 
 	pCamera = new SPI(SPI::kOnboardCS0);
 	pCamera->SetMSBFirst();
@@ -42,143 +45,148 @@ void PixyCam::Run(PixyCam *pInstance)
 
 		 //printf("data = %04X state %d\n", uPixiWord, ePixyComState);
 
-		 switch (ePixyComState)
-		 {
-			 case  PIXYCOM_UNSYNCHED:
-				 // look for synch word
+		 pInstance->ParseWord(uPixiWord);
+	 }
+}
 
-				 if(uPixiWord == PIXICOM_FRAMESYNCWORD)
-				 {
-					 ePixyComState = PIXYCOM_LOOK4SECONDSYNCWORD;
-				 }
-				 else if(uPixiWord == 0)
+void PixyCam::ParseWord(uint16_t uPixiWord)
+{
+	 switch (ePixyComState)
+	 {
+		 case  PIXYCOM_UNSYNCHED:
+			 // look for synch word
+
+			 if(uPixiWord == PIXICOM_FRAMESYNCWORD)
+			 {
+				 ePixyComState = PIXYCOM_LOOK4SECONDSYNCWORD;
+			 }
+			 else if(uPixiWord == 0)
+			 {
 				 {
-					 {
-						//std::lock_guard<priority_recursive_mutex> sync(pInstance->mutexData);
-						pInstance->bBlockFound = false;
-						pInstance->fCentroid = 0.0;
-					 }
+					//std::lock_guard<priority_recursive_mutex> sync(mutexData);
+					bBlockFound = false;
+					fCentroid = 0.0;
 				 }
-				 break;
+			 }
+			 break;
 
-			 case  PIXYCOM_LOOK4SECONDSYNCWORD:
-				 // look for second consecutive synch word
+		 case  PIXYCOM_LOOK4SECONDSYNCWORD:
+			 // look for second consecutive synch word
 
-				 //TODO look for color sync word as well?
+			 //TODO look for color sync word as well?
 
-				 if(uPixiWord == PIXICOM_FRAMESYNCWORD)
-				 {
-					 uBlockByteCount = 0;
-					 ePixyComState = PIXYCOM_GETBLOCKDATA;
-				 }
-				 else if(uPixiWord == 0)
-				 {
-					 {
-						//std::lock_guard<priority_recursive_mutex> sync(pInstance->mutexData);
-						pInstance->bBlockFound = false;
-						pInstance->fCentroid = 0.0;
-					 }
-					 ePixyComState = PIXYCOM_UNSYNCHED;
-				 }
-				 else
+			 if(uPixiWord == PIXICOM_FRAMESYNCWORD)
+			 {
+				 uBlockByteCount = 0;
+				 ePixyComState = PIXYCOM_GETBLOCKDATA;
+			 }
+			 else if(uPixiWord == 0)
+			 {
 				 {
-					 // keep looking for a new frame
-
-					 ePixyComState = PIXYCOM_UNSYNCHED;
+					//std::lock_guard<priority_recursive_mutex> sync(mutexData);
+					bBlockFound = false;
+					fCentroid = 0.0;
 				 }
-				 break;
-
-			 case  PIXYCOM_STARTOFRAME:
-				 ePixyComState = PIXYCOM_STARTOFBLOCK;
-				 uBlockByteCount = 0;
-				 break;
+				 ePixyComState = PIXYCOM_UNSYNCHED;
+			 }
+			 else
+			 {
+				 // keep looking for a new frame
 
-			 case  PIXYCOM_STARTOFBLOCK:
-				 ePixyComState = PIXYCOM_GETBLOCKDATA;
+				 ePixyComState = PIXYCOM_UNSYNCHED;
+			 }
+			 break;
+
+		 case  PIXYCOM_STARTOFRAME:
+			 ePixyComState = PIXYCOM_STARTOFBLOCK;
+			 uBlockByteCount = 0;
+			 break;
+
+		 case  PIXYCOM_STARTOFBLOCK:
+			 ePixyComState = PIXYCOM_GETBLOCKDATA;
+			 uBlockByteCount = 0;
+			 break;
+
+		 case  PIXYCOM_GETBLOCKDATA:
+			 uCurrentBlock[uBlockByteCount++] = uPixiWord;
+
+			 if(uBlockByteCount >= 6)
+			 {
+				 ePixyComState = PIXYCOM_ENDOFBLOCK;
+			 }
+			 break;
+
+		 case  PIXYCOM_ENDOFBLOCK:
+			 if(uPixiWord == PIXICOM_FRAMESYNCWORD)
+			 {
+				 // is this the last block?
 				 uBlockByteCount = 0;
-				 break;
+				 ePixyComState = PIXYCOM_ENDOFFRAME;
 
-			 case  PIXYCOM_GETBLOCKDATA:
-				 pInstance->uCurrentBlock[uBlockByteCount++] = uPixiWord;
+				 // calibrate on known image, verify x,y,w,h make sense
+				 // TODO verify checksum
+				 // TODO should we only follow the largest match?
+				 // TODO convert x and y to % of full view? - what would help servo math the best
+				 // TODO is the first signature labeled 0 or 1?
 
-				 if(uBlockByteCount >= 6)
 				 {
-					 ePixyComState = PIXYCOM_ENDOFBLOCK;
-				 }
-				 break;
+					    //std::lock_guard<priority_recursive_mutex> sync(mutexData);
 
-			 case  PIXYCOM_ENDOFBLOCK:
-				 if(uPixiWord == PIXICOM_FRAMESYNCWORD)
-				 {
-					 // is this the last block?
-					 uBlockByteCount = 0;
-					 ePixyComState = PIXYCOM_ENDOFFRAME;
-
-					 // calibrate on known image, verify x,y,w,h make sense
-					 // TODO verify checksum
-					 // TODO should we only follow the largest match?
-					 // TODO convert x and y to % of full view? - what would help servo math the best
-					 // TODO is the first signature labeled 0 or 1?
-
-					 {
-						    //std::lock_guard<priority_recursive_mutex> sync(pInstance->mutexData);
-
-						    if(pInstance->uCurrentBlock[1] == 1)
-						    {
-						    	// centroid of the largest block (the first signature)
-
-						    	pInstance->bBlockFound = true;
-						    	pInstance->fCentroid = (float)((int)pInstance->uCurrentBlock[2] - 159.5) / 159.5; // 0-319 0-199y
-						    }
-					 }
-
-					 //printf("%d: x = %u, y = %u, w = %u, h = %u\n",
-					 //		 pInstance->uCurrentBlock[1],
-					 //		 pInstance->uCurrentBlock[2],
-					 //		 pInstance->uCurrentBlock[3],
-					 //		 pInstance->uCurrentBlock[4],
-					 //		 pInstance->uCurrentBlock[5]);
-				 }
-				 else
-				 {
-					 ePixyComState = PIXYCOM_UNSYNCHED;
+					    if(uCurrentBlock[1] == 1)
+					    {
+					    	// centroid of the largest block (the first signature)
+
+					    	bBlockFound = true;
+					    	fCentroid = (float)((int)uCurrentBlock[2] - 159.5) / 159.5; // 0-319 0-199y
+					    }
 				 }
-				 break;
 
-			 case  PIXYCOM_ENDOFFRAME:
-				 if(uPixiWord == PIXICOM_FRAMESYNCWORD)
-				 {
-					 // new frame and new block
+				 //printf("%d: x = %u, y = %u, w = %u, h = %u\n",
+				 //		 uCurrentBlock[1],
+				 //		 uCurrentBlock[2],
+				 //		 uCurrentBlock[3],
+				 //		 uCurrentBlock[4],
+				 //		 uCurrentBlock[5]);
+			 }
+			 else
+			 {
+				 ePixyComState = PIXYCOM_UNSYNCHED;
+			 }
+			 break;
+
+		 case  PIXYCOM_ENDOFFRAME:
+			 if(uPixiWord == PIXICOM_FRAMESYNCWORD)
+			 {
+				 // new frame and new block
+
+				 uBlockByteCount = 0;
+				 ePixyComState = PIXYCOM_GETBLOCKDATA;
+			 }
+			 else if(uPixiWord == 0)
+			 {
+				 // new frame but there are no queued objects
 
-					 uBlockByteCount = 0;
-					 ePixyComState = PIXYCOM_GETBLOCKDATA;
-				 }
-				 else if(uPixiWord == 0)
 				 {
-					 // new frame but there are no queued objects
-
-					 {
-						//std::lock_guard<priority_recursive_mutex> sync(pInstance->mutexData);
-						pInstance->bBlockFound = false;
-						pInstance->fCentroid = 0.0;
-					 }
-					 ePixyComState = PIXYCOM_UNSYNCHED;
+					//std::lock_guard<priority_recursive_mutex> sync(mutexData);
+					bBlockFound = false;
+					fCentroid = 0.0;
 				 }
-				 else
-				 {
-					 // new block, eat the first word
+				 ePixyComState = PIXYCOM_UNSYNCHED;
+			 }
+			 else
+			 {
+				 // new block, eat the first word
 
-					 pInstance->uCurrentBlock[0] = uPixiWord;
-					 uBlockByteCount = 1;
-					 ePixyComState = PIXYCOM_GETBLOCKDATA;
-				 }
-				 break;
+				 uCurrentBlock[0] = uPixiWord;
+				 uBlockByteCount = 1;
+				 ePixyComState = PIXYCOM_GETBLOCKDATA;
+			 }
+			 break;
 
-			 default:
-				 // should never get here!
-				 ePixyComState = PIXYCOM_UNSYNCHED;
-				 break;
-		 }
+		 default:
+			 // should never get here!
+			 ePixyComState = PIXYCOM_UNSYNCHED;
+			 break;
 	 }
 }
 
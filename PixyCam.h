@@ -35,13 +35,16 @@ class PixyCam : public PIDSource{
 
 public:
 
-	PixyCam();
+	PixyCam(bool bStartTask = true);		// false leaves feeding ParseWord() to the caller
 	~PixyCam();
 	static void Run(PixyCam *);
+	void ParseWord(uint16_t uPixiWord);		// one big endian word off the SPI bus
 	double PIDGet();
 	bool GetCentroid(float &fNewCentroid);   // -1.0 to 1.0
 private:
 	Task* pTask;
+	PIXICOM_STATES ePixyComState;
+	uint16_t uBlockByteCount;
     uint16_t uCurrentBlock[12];
     uint16_t uCommands[12];
 	bool bBlockFound;
@@ -6,9 +6,16 @@
  * that implement behaviors for each part for the robot.
  */
 
+#include <atomic>
+#include <stdio.h>
+#include <thread>
+#include <time.h>
+
 #include <ComponentBase.h>
 #include <RhsRobot.h>
 #include <RobotParams.h>
+#include <MessageBus.h>
+#include <ThreadConfig.h>
 #include "WPILib.h"
 
 //Robot
@@ -23,6 +30,7 @@ RhsRobot::RhsRobot() {
 	shooter = NULL;
 	hanger = NULL;
 	shootSeq = NULL;
+	executor = NULL;
 
 	iLoop = 0;
 }
@@ -35,6 +43,8 @@ RhsRobot::~RhsRobot() {
 		delete (*nextComponent);
 	}
 
+	FlightLog::Stop();
+	delete executor;
 	delete Controller_1;
 }
 
@@ -44,6 +54,20 @@ void RhsRobot::Init() {
 	 * EXAMPLE:	drivetrain = NULL; (in constructor)
 	 * 			drivetrain = new Drivetrain(); (in RhsRobot::Init())
 	 */
+	MessageQueue::SetTracing(MESSAGE_TRACING);
+	ComponentBase::SetExecutorMode(EXECUTOR_MODE);
+
+	if(FLIGHT_LOG)
+	{
+		char szFileName[64];
+		char szStarted[32];
+		time_t now = time(NULL);
+
+		strftime(szStarted, sizeof(szStarted), "%Y%m%d_%H%M%S", localtime(&now));
+		snprintf(szFileName, sizeof(szFileName), FLIGHT_LOG_FILE, szStarted);
+		FlightLog::Start(szFileName);
+	}
+
 	Controller_1 = new Joystick(0);
 	Controller_2 = new Joystick(1);
 	drivetrain = new Drivetrain();
@@ -85,16 +109,28 @@ void RhsRobot::Init() {
 	{
 		nextComponent = ComponentSet.insert(nextComponent, hanger);
 	}
+
+	if(EXECUTOR_MODE)
+	{
+		// autonomous first so the commands it sends are handled the same tick
+
+		executor = new ComponentExecutor(EXECUTOR_TICK_PERIOD);
+
+		if(autonomous) executor->Add(autonomous);
+		if(drivetrain) executor->Add(drivetrain);
+		if(arm) executor->Add(arm);
+		if(tail) executor->Add(tail);
+		if(shooter) executor->Add(shooter);
+		if(hanger) executor->Add(hanger);
+
+		executor->Start();
+	}
 }
 
 void RhsRobot::OnStateChange() {
-	std::vector<ComponentBase *>::iterator nextComponent;
+	// everyone who cares has subscribed, not just the components we own
 
-	for(nextComponent = ComponentSet.begin();
-			nextComponent != ComponentSet.end(); ++nextComponent)
-	{
-		(*nextComponent)->SendMessage(&robotMessage);
-	}
+	MessageBus::Publish(MESSAGE_TOPIC_ROBOT_STATE, &robotMessage);
 }
 
 void RhsRobot::Run() {
@@ -121,14 +157,15 @@ void RhsRobot::Run() {
 		robotMessage.command = COMMAND_DRIVETRAIN_DRIVE_TANK;
 		//robotMessage.params.tankDrive.left = TANK_DRIVE_LEFT;
 		//robotMessage.params.tankDrive.right = TANK_DRIVE_RIGHT;
-		robotMessage.params.tankDrive.left = 0.75;
-		robotMessage.params.tankDrive.right = 0.75;
+		GetParams<COMMAND_DRIVETRAIN_DRIVE_TANK>(robotMessage).left = 0.75;
+		GetParams<COMMAND_DRIVETRAIN_DRIVE_TANK>(robotMessage).right = 0.75;
 		drivetrain->SendMessage(&robotMessage);
 #endif
 		robotMessage.command = COMMAND_DRIVETRAIN_DRIVE_CHEEZY;
-		 			robotMessage.params.cheezyDrive.wheel = CHEEZY_DRIVE_WHEEL;
-		 			robotMessage.params.cheezyDrive.throttle = CHEEZY_DRIVE_THROTTLE;
-		 			robotMessage.params.cheezyDrive.bQuickturn = CHEEZY_DRIVE_QUICKTURN;
+		CheezyDriveParams &cheezy = GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(robotMessage);
+		 			cheezy.wheel = CHEEZY_DRIVE_WHEEL;
+		 			cheezy.throttle = CHEEZY_DRIVE_THROTTLE;
+		 			cheezy.bQuickturn = CHEEZY_DRIVE_QUICKTURN;
 		drivetrain->SendMessage(&robotMessage);
 
 		if(DRIVE_ZERO_GYRO){
@@ -137,12 +174,12 @@ void RhsRobot::Run() {
 
 		if(DRIVE_SEARCHON){
 			robotMessage.command = COMMAND_AUTONOMOUS_SEARCHGOAL;
-			robotMessage.params.armParams.direction = true;
+			GetParams<COMMAND_AUTONOMOUS_SEARCHGOAL>(robotMessage).direction = true;
 			drivetrain->SendMessage(&robotMessage);
 		}
 		if(DRIVE_SEARCHOFF){
 			robotMessage.command = COMMAND_AUTONOMOUS_SEARCHGOAL;
-			robotMessage.params.armParams.direction = false;
+			GetParams<COMMAND_AUTONOMOUS_SEARCHGOAL>(robotMessage).direction = false;
 			drivetrain->SendMessage(&robotMessage);
 		}
 	}
@@ -183,11 +220,11 @@ void RhsRobot::Run() {
 
 		if(ARM_INTAKE_IN){
 			robotMessage.command = COMMAND_ARM_INTAKE;
-			robotMessage.params.armParams.direction = true;
+			GetParams<COMMAND_ARM_INTAKE>(robotMessage).direction = true;
 			arm->SendMessage(&robotMessage);
 		}else if (ARM_INTAKE_OUT){
 			robotMessage.command = COMMAND_ARM_INTAKE;
-			robotMessage.params.armParams.direction = false;
+			GetParams<COMMAND_ARM_INTAKE>(robotMessage).direction = false;
 			arm->SendMessage(&robotMessage);
 		}
 	}
@@ -221,9 +258,10 @@ void RhsRobot::Run() {
 			robotMessage.command = COMMAND_HANGER_HANG;
 			hanger->SendMessage(&robotMessage);
 			robotMessage.command = COMMAND_DRIVETRAIN_DRIVE_CHEEZY;
-			 			robotMessage.params.cheezyDrive.wheel = 0;
-			 			robotMessage.params.cheezyDrive.throttle = .1;
-			 			robotMessage.params.cheezyDrive.bQuickturn = false;
+			CheezyDriveParams &cheezy = GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(robotMessage);
+			 			cheezy.wheel = 0;
+			 			cheezy.throttle = .1;
+			 			cheezy.bQuickturn = false;
 			drivetrain->SendMessage(&robotMessage);
 		}
 	}
@@ -231,12 +269,84 @@ void RhsRobot::Run() {
 	if((iLoop++ % 50) == 0)
 	 	{
 	 		robotMessage.command = COMMAND_SYSTEM_CONSTANTS;
-	 		robotMessage.params.system.fBattery = DriverStation::GetInstance().GetBatteryVoltage();
+	 		GetParams<COMMAND_SYSTEM_CONSTANTS>(robotMessage).fBattery = DriverStation::GetInstance().GetBatteryVoltage();
 
 	 		// send to interested subsystems
 
-	 		drivetrain->SendMessage(&robotMessage);
+	 		MessageBus::Publish(MESSAGE_TOPIC_SYSTEM, &robotMessage);
+
+	 		// how long it takes a state change to reach everyone
+
+	 		MessageTopicStats stats;
+
+	 		MessageBus::GetTopicStats(MESSAGE_TOPIC_ROBOT_STATE, stats);
+	 		SmartDashboard::PutNumber("state fanout avg us", stats.fFanoutAvgUs);
+	 		SmartDashboard::PutNumber("state fanout max us", stats.uFanoutMaxUs);
+
+	 		// the pit crew can ask for the message traces without waiting for the match to end
+
+	 		if(SmartDashboard::GetBoolean("dump trace", false))
+	 		{
+	 			SmartDashboard::PutBoolean("dump trace", false);
+	 			robotMessage.command = COMMAND_SYSTEM_TRACE_DUMP;
+	 			MessageBus::Publish(MESSAGE_TOPIC_DIAGNOSTICS, &robotMessage);
+	 		}
+
+	 		// play a recorded match back into one component, only on the bench
+
+	 		if((GetCurrentRobotState() == ROBOT_STATE_TEST) && SmartDashboard::GetBoolean("replay", false))
+	 		{
+	 			SmartDashboard::PutBoolean("replay", false);
+	 			StartReplay(SmartDashboard::GetString("replay queue", DRIVETRAIN_QUEUE),
+	 					SmartDashboard::GetNumber("replay speed", 1.0));
+	 		}
+
+	 		unsigned uRecords;
+	 		unsigned uDropped;
+	 		unsigned long long ullBytes;
+
+	 		FlightLog::GetStats(uRecords, uDropped, ullBytes);
+	 		SmartDashboard::PutNumber("flight log records", uRecords);
+	 		SmartDashboard::PutNumber("flight log dropped", uDropped);
+	 		SmartDashboard::PutNumber("flight log kB", ullBytes / 1024);
 	 	}
 }
 
+void RhsRobot::StartReplay(std::string queueName, float fSpeed)
+{
+	static std::atomic<bool> bReplaying(false);
+
+	if(bReplaying.exchange(true))
+	{
+		return;					// one at a time
+	}
+
+	// it takes as long as the match did, so it gets its own thread
+
+	std::thread([queueName, fSpeed]() {
+		// otherwise it keeps tRobot's priority, above the component it feeds
+
+		ThreadConfig::Apply(REPLAY_TASKNAME, REPLAY_PRIORITY);
+
+		FlightReplay replay;
+
+		SmartDashboard::PutString("replay status", "running");
+
+		if(replay.Load(FLIGHT_REPLAY_FILE) && replay.Run(queueName.c_str(), fSpeed))
+		{
+			SmartDashboard::PutNumber("replay sent", replay.GetSent());
+			SmartDashboard::PutNumber("replay responses", replay.GetResponses());
+			SmartDashboard::PutNumber("replay late max us", replay.GetLateMaxUs());
+			SmartDashboard::PutNumber("replay seconds", replay.GetDuration());
+			SmartDashboard::PutString("replay status", "done");
+		}
+		else
+		{
+			SmartDashboard::PutString("replay status", "failed");
+		}
+
+		bReplaying.store(false);
+	}).detach();
+}
+
 START_ROBOT_CLASS(RhsRobot)
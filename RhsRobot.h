@@ -16,6 +16,8 @@
 #include <Shooter.h>
 #include <Hanger.h>
 #include "ShooterSequence.h"
+#include <ComponentExecutor.h>
+#include <FlightLog.h>
 
 class RhsRobot : public RhsRobotBase
 {
@@ -33,6 +35,7 @@ private:
 	Shooter* shooter;
 	Hanger* hanger;
 	ShooterSequence* shootSeq;
+	ComponentExecutor* executor;
 
 	std::vector <ComponentBase *> ComponentSet;
 	
@@ -41,6 +44,7 @@ private:
 	void Run();
 	bool CheckButtonPressed(bool, bool);
 	bool CheckButtonReleased(bool, bool);
+	void StartReplay(std::string queueName, float fSpeed);
 
 
 	int iLoop;
@@ -10,7 +10,7 @@
 #include <Autonomous.h>
 #include <RhsRobotBase.h>			//For the local header file
 #include <RobotParams.h>			//For various robot parameters
-#include <sched.h>
+#include <ThreadConfig.h>			//For thread priorities and placement
 
 //Built-In
 
@@ -20,18 +20,11 @@
 
 RhsRobotBase::RhsRobotBase()			//Constructor
 {
-	cpu_set_t  mask;
-	//struct sched_param param;
-
 	printf("\n\t\t%s \"%s\"\n\tVersion %s built %s at %s\n\n", ROBOT_NAME, ROBOT_NICKNAME, ROBOT_VERSION, __DATE__, __TIME__);
 
-	// run our code on the second core
-
-	CPU_ZERO(&mask);
-	CPU_SET(1, &mask);
-	sched_setaffinity(0, sizeof(mask), &mask);
+	// every thread we start inherits this until it applies its own settings
 
-	// what are our priority limits?
+	ThreadConfig::Apply(ROBOT_TASKNAME, ROBOT_PRIORITY);
 
 	previousRobotState = ROBOT_STATE_UNKNOWN;
 	currentRobotState = ROBOT_STATE_UNKNOWN;
@@ -158,6 +151,11 @@ void RhsRobotBase::StartCompetition()			//Robot's main function
 
 		previousRobotState = currentRobotState;
 
+		if(loop == THREAD_REPORT_LOOP)
+		{
+			ThreadConfig::Report();			//Everyone has started by now
+		}
+
 		++loop;		//Increment the loop counter
 	}
 }
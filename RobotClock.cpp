@@ -0,0 +1,78 @@
+/** \file
+ * The one clock every robot task measures and sleeps by.
+ */
+
+#include <errno.h>
+#include <time.h>
+
+#include <RobotClock.h>
+
+float RobotClock::fRate = 1.0;
+long long RobotClock::llBaseRealUs = 0;
+long long RobotClock::llBaseRobotUs = 0;
+
+long long RobotClock::RealNowUs()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return((long long)now.tv_sec * 1000000LL + now.tv_nsec / 1000);
+}
+
+long long RobotClock::NowUs()
+{
+	if(fRate == 1.0)
+	{
+		return(llBaseRobotUs + RealNowUs() - llBaseRealUs);
+	}
+
+	return(llBaseRobotUs + (long long)((RealNowUs() - llBaseRealUs) * fRate));
+}
+
+double RobotClock::Now()
+{
+	return(NowUs() / 1000000.0);
+}
+
+void RobotClock::SleepUntilUs(long long llDeadlineUs)
+{
+	long long llRealUs = llBaseRealUs + RealUs(llDeadlineUs - llBaseRobotUs);
+	struct timespec deadline;
+
+	deadline.tv_sec = llRealUs / 1000000LL;
+	deadline.tv_nsec = (llRealUs % 1000000LL) * 1000;
+
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+	{
+		// intentionally empty
+	}
+}
+
+void RobotClock::SleepUs(long long llUs)
+{
+	SleepUntilUs(NowUs() + llUs);
+}
+
+void RobotClock::Sleep(double fSeconds)
+{
+	SleepUs((long long)(fSeconds * 1000000.0));
+}
+
+long long RobotClock::RealUs(long long llUs)
+{
+	if(fRate == 1.0)
+	{
+		return(llUs);
+	}
+
+	return((long long)(llUs / fRate));
+}
+
+void RobotClock::SetRate(float fRate)
+{
+	// robot time carries on from where it is, only its speed changes
+
+	llBaseRobotUs = NowUs();
+	llBaseRealUs = RealNowUs();
+	RobotClock::fRate = fRate;
+}
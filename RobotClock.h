@@ -0,0 +1,39 @@
+/** \file
+ * The one clock every robot task measures and sleeps by.
+ *
+ * On the robot it runs at real time and reads exactly what CLOCK_MONOTONIC
+ * reads.  The simulator can run it faster with SetRate(): robot time then
+ * passes fRate times faster than real time, every sleep is shortened to match
+ * and a 15 second autonomous plays out in a fraction of a second.  WPILib's
+ * Wait() and Timer follow the same clock in the simulator (see sim/), so the
+ * components' delays, control loops and message timeouts all speed up together.
+ *
+ * The rate must be set before any task starts; the clock itself takes no locks.
+ */
+
+#ifndef ROBOT_CLOCK_H
+#define ROBOT_CLOCK_H
+
+class RobotClock
+{
+public:
+	static long long NowUs();						// robot time, microseconds
+	static double Now();							// robot time, seconds
+
+	static void SleepUntilUs(long long llDeadlineUs);
+	static void SleepUs(long long llUs);
+	static void Sleep(double fSeconds);
+
+	static long long RealUs(long long llUs);		// how long llUs of robot time takes in real time
+	static void SetRate(float fRate);
+	static float GetRate() { return(fRate); };
+
+private:
+	static long long RealNowUs();
+
+	static float fRate;
+	static long long llBaseRealUs;					// real time when the rate was last set
+	static long long llBaseRobotUs;					// robot time when the rate was last set
+};
+
+#endif //ROBOT_CLOCK_H
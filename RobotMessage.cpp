@@ -0,0 +1,81 @@
+/** \file
+ *  Messages used for intertask communications
+ */
+
+#include <RobotMessage.h>
+
+///indexed by MessageCommand, keep in the same order as the enum
+static const char * const szCommandNames[] = {
+	"UNKNOWN",
+	"SYSTEM_MSGTIMEOUT",
+	"SYSTEM_OK",
+	"SYSTEM_ERROR",
+	"SYSTEM_CONSTANTS",
+	"SYSTEM_TRACE_DUMP",
+	"ROBOT_STATE_DISABLED",
+	"ROBOT_STATE_AUTONOMOUS",
+	"ROBOT_STATE_TELEOPERATED",
+	"ROBOT_STATE_TEST",
+	"ROBOT_STATE_UNKNOWN",
+	"AUTONOMOUS_RUN",
+	"AUTONOMOUS_COMPLETE",
+	"AUTONOMOUS_RESPONSE_OK",
+	"AUTONOMOUS_RESPONSE_ERROR",
+	"CHECKLIST_RUN",
+	"AUTONOMOUS_SEARCHGOAL",
+	"AUTONOMOUS_SEARCHBALL",
+	"AUTONOMOUS_INTAKE",
+	"AUTONOMOUS_MOVEINTAKE",
+	"AUTONOMOUS_THROWUP",
+	"AUTONOMOUS_SHOOT",
+	"DRIVETRAIN_STOP",
+	"DRIVETRAIN_DRIVE_TANK",
+	"DRIVETRAIN_DRIVE_ARCADE",
+	"DRIVETRAIN_AUTO_MOVE",
+	"DRIVETRAIN_STRAIGHT",
+	"DRIVETRAIN_MSTRAIGHT",
+	"DRIVETRAIN_MLINE",
+	"DRIVETRAIN_TURN",
+	"DRIVETRAIN_DRIVE_SPLITARCADE",
+	"DRIVETRAIN_DRIVE_CHEEZY",
+	"DRIVETRAIN_REDSENSE",
+	"DRIVETRAIN_SETANGLE",
+	"ARM_FAR",
+	"ARM_CLOSE",
+	"ARM_INTAKE",
+	"ARM_INTAKE_STOP",
+	"ARM_INTAKE_OUT",
+	"ARM_SHOOT",
+	"ARM_MOVE_INTAKE",
+	"ARM_MOVE_RIDE",
+	"ARM_AUTO_MOVE_RIDE",
+	"ARM_LEDOFF",
+	"ARM_LEDWHITE",
+	"ARM_LEDCOLOR",
+	"ARM_ENABLE",
+	"ARM_MOVE_AFTERSHOOT",
+	"HANGER_HANG",
+	"HANGER_SOLENOID_ENABLE",
+	"HANGER_SOLENOID_DISABLE",
+	"TAIL_RAISE",
+	"TAIL_LOWER",
+	"SHOOTER_SHOOT",
+	"SHOOTER_SHOOTER_OPEN",
+	"SHOOTER_SHOOTER_CLOSE",
+	"SHOOTER_JAW_OPEN",
+	"SHOOTER_JAW_CLOSE",
+	"COMPONENT_TEST",
+};
+
+static_assert(sizeof(szCommandNames) / sizeof(szCommandNames[0]) == COMMAND_LAST,
+		"szCommandNames must have one entry per MessageCommand");
+
+const char *GetCommandName(MessageCommand command)
+{
+	if((command < 0) || (command >= COMMAND_LAST))
+	{
+		return("INVALID");
+	}
+
+	return(szCommandNames[command]);
+}
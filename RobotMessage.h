@@ -49,6 +49,7 @@ enum MessageCommand {
 	COMMAND_SYSTEM_OK,					//!< COMMAND_SYSTEM_OK
 	COMMAND_SYSTEM_ERROR,				//!< COMMAND_SYSTEM_ERROR
 	COMMAND_SYSTEM_CONSTANTS,
+	COMMAND_SYSTEM_TRACE_DUMP,			//!< Tells components to write out their message trace histograms
 
 	COMMAND_ROBOT_STATE_DISABLED,		//!< Tells all components that the robot is disabled
 	COMMAND_ROBOT_STATE_AUTONOMOUS,		//!< Tells all components that the robot is in auto
@@ -173,11 +174,23 @@ union MessageParams {
 	SystemParams system;
 };
 
+///Filled in by MessageQueue::Send when tracing is turned on
+struct MessageTrace {
+	long long llSentUs;			//!< monotonic time the message was sent
+	unsigned uSequence;			//!< counts every message sent by anyone
+	unsigned uSource;			//!< sending task, 0 is the main robot task
+};
+
 ///A structure containing a command, a set of parameters, and a reply id, sent between components
 struct RobotMessage {
 	MessageCommand command;
 	const char* replyQ;
+	unsigned uCorrelation;		//!< copied into the response, see PendingResponses.h
 	MessageParams params;
+	MessageTrace trace;
 };
 
+///Printable name of a command, used for traces and logs
+const char *GetCommandName(MessageCommand command);
+
 #endif //ROBOT_MESSAGE_H
@@ -11,12 +11,18 @@
 
 //Robot
 #include <JoystickLayouts.h>			//For joystick layouts
+#include <MessageQueue.h>				//For mailbox overflow policies
 
 //Robot Params
 const char* const ROBOT_NAME =		"RhsRobot2016";	//Formal name
 const char* const ROBOT_NICKNAME =  "Mittens";		//Nickname
 const char* const ROBOT_VERSION =	"1.1";			//Version
 
+//Files the robot reads and writes live here; the simulator builds with its own directory
+#ifndef ROBOT_HOME_DIR
+#define ROBOT_HOME_DIR		"/home/lvuser/"
+#endif
+
 //Robot Mode Macros - used to tell what mode the robot is in
 #define ISAUTO			RobotBase::getInstance().IsAutonomous()
 #define ISTELEOPERATED	RobotBase::getInstance().IsOperatorControl()
@@ -30,18 +36,67 @@ const char* const ROBOT_VERSION =	"1.1";			//Version
 #define TRUNC_HUND(a)		((int)(100 * a)) * .01
 #define PRINTAUTOERROR		printf("Early Death! %s %i \n", __FILE__, __LINE__);
 
-//Task Params - Defines component task priorites relative to the default priority.
-//EXAMPLE: const int DRIVETRAIN_PRIORITY = DEFAULT_PRIORITY -2;
-const int DEFAULT_PRIORITY = 150;
-const int COMPONENT_PRIORITY 	= DEFAULT_PRIORITY;
-const int DRIVETRAIN_PRIORITY 	= DEFAULT_PRIORITY;
+//Task Params - Linux SCHED_FIFO priorities, 1 is the lowest and 99 the highest.  0 leaves a task
+//in the normal time shared class, anything that polls without sleeping MUST use 0 or it will
+//starve everything else on its CPU.  Applied by ThreadConfig, see THREAD_PARAMS below.
+//The driver station loop shares CPU 1 with the components, so it runs above all of them, it
+//only ever sleeps in WaitForData() and a component stuck in a handler can not hold it up.
+//EXAMPLE: const int DRIVETRAIN_PRIORITY = DEFAULT_PRIORITY + 10;
+const int DEFAULT_PRIORITY = 20;
+const int ROBOT_PRIORITY		= DEFAULT_PRIORITY + 16;	// above every component on CPU 1
+const int COMPONENT_PRIORITY 	= 0;
+const int DRIVETRAIN_PRIORITY 	= DEFAULT_PRIORITY + 10;
 const int AUTONOMOUS_PRIORITY 	= DEFAULT_PRIORITY;
-const int AUTOEXEC_PRIORITY 	= DEFAULT_PRIORITY;
+const int AUTOEXEC_PRIORITY 	= DEFAULT_PRIORITY;	// sleeps on its command responses, and while paused
 const int AUTOPARSER_PRIORITY 	= DEFAULT_PRIORITY;
 const int ARM_PRIORITY 			= DEFAULT_PRIORITY;
 const int TAIL_PRIORITY 		= DEFAULT_PRIORITY;
 const int SHOOTER_PRIORITY 		= DEFAULT_PRIORITY;
 const int HANGER_PRIORITY 		= DEFAULT_PRIORITY;
+const int SEQUENCE_PRIORITY		= DEFAULT_PRIORITY;
+const int CHEEZY_PRIORITY		= DEFAULT_PRIORITY + 12;
+const int GYRO_PRIORITY			= DEFAULT_PRIORITY + 14;
+const int PIXY_PRIORITY			= 0;		// polls the camera without sleeping
+const int TALON_PRIORITY		= 0;		// current monitors write log files
+const int EXECUTOR_PRIORITY		= DRIVETRAIN_PRIORITY;
+const int FLIGHT_LOG_PRIORITY	= 0;		// writes to the SD card
+const int REPLAY_PRIORITY		= 0;		// sends flat out at "replay speed" 0
+
+//Task Periods - Components with a period run on a fixed tick, draining their messages each time,
+//instead of running once per message.  Use 0.0 to stay message driven.
+//EXAMPLE: const float DRIVETRAIN_TICK_PERIOD = 0.01;
+const float COMPONENT_TICK_PERIOD	= 0.0;
+const float DRIVETRAIN_TICK_PERIOD	= 0.010;
+const float AUTONOMOUS_TICK_PERIOD	= 0.0;
+const float ARM_TICK_PERIOD			= 0.0;		// intake toggle needs MSGTIMEOUT only after a release
+const float TAIL_TICK_PERIOD		= 0.020;
+const float SHOOTER_TICK_PERIOD		= 0.050;
+const float HANGER_TICK_PERIOD		= 0.050;
+
+//Autonomous Responses - How long the script waits for a component to answer a command (seconds)
+//before giving up on it.  Autonomous is only 15 seconds long, so nothing should take longer.
+const float AUTONOMOUS_RESPONSE_TIMEOUT	= 15.0;
+const float AUTONOMOUS_SHOOT_ARM_TIMEOUT	= 3.0;		// arm to the far position
+const float AUTONOMOUS_SHOOT_AIM_TIMEOUT	= 8.0;		// drivetrain lines up on the goal with the pixy
+const float AUTONOMOUS_PERIOD			= 15.0;		// how long autonomous lasts, scripts are checked against it
+
+//Shooter Sequence - The waits in ShooterSequence::Run(), SHOOT and SHORT in a script run all of it
+const float SHOOTER_SEQUENCE_ARM_DELAY		= 1.0;		// arm down to close, only if it is not there already
+const float SHOOTER_SEQUENCE_ROTATE_BACK	= 0.2;		// intake rotated out
+const float SHOOTER_SEQUENCE_PRE_SHOOT		= 1.0;		// jaw opening
+const float SHOOTER_SEQUENCE_POST_SHOOT		= 0.5;		// ball leaving
+const float SHOOTER_SEQUENCE_TIME = SHOOTER_SEQUENCE_ARM_DELAY + SHOOTER_SEQUENCE_ROTATE_BACK +
+		SHOOTER_SEQUENCE_PRE_SHOOT + SHOOTER_SEQUENCE_POST_SHOOT;
+
+//Executor Mode - When true no component starts its own task.  One executor task steps every
+//component in a fixed order each EXECUTOR_TICK_PERIOD (see ComponentExecutor.h).  Handlers that
+//Wait() inside Run() hold up every component, so this stays off until they are gone.
+const bool EXECUTOR_MODE			= false;
+const float EXECUTOR_TICK_PERIOD	= 0.010;
+
+//Run Budgets - ComponentBase warns when a single Run() takes longer than this.  Ticked components
+//use their tick period unless they call SetRunBudget(), everyone else uses the default.
+const float DEFAULT_RUN_BUDGET		= 0.020;
 
 //Task Names - Used when you view the task list but used by the operating system
 //EXAMPLE: const char* DRIVETRAIN_TASKNAME = "tDrive";
@@ -56,9 +111,51 @@ const char* const SHOOTER_TASKNAME		= "tShooter";
 const char* const HANGER_TASKNAME		= "tHanger";
 const char* const SHOOTER_SEQ_TASKNAME	= "tShooterSeq";
 const char* const HANGER_SEQ_TASKNAME	= "tSHangerSeq";
-//TODO change these variables throughout the code to PIPE or whatever instead  of QUEUE
+const char* const ROBOT_TASKNAME		= "tRobot";
+const char* const CHEEZY_TASKNAME		= "tCheezy";
+const char* const GYRO_TASKNAME			= "tADSRX543Z";
+const char* const PIXY_TASKNAME			= "tPixy";
+const char* const TALON_TASKNAME		= "tTalon";		// followed by the CAN id
+const char* const EXECUTOR_TASKNAME		= "tExec";
+const char* const FLIGHT_LOG_TASKNAME	= "tFlightLog";
+const char* const REPLAY_TASKNAME		= "tReplay";
+
+//Thread Placement - Priority and CPU for every thread we start, looked up by task name when the
+//thread starts.  A trailing '*' matches any suffix.  CPU 0 also runs the driver station
+//communications, so the control loops stay on CPU 1 and the slow helpers go to CPU 0.
+//Use -1 to leave a thread on the CPUs it inherited.
+struct ThreadParams {
+	const char *szName;
+	int iPriority;
+	int iCpu;
+};
+
+const ThreadParams THREAD_PARAMS[] = {
+	{ ROBOT_TASKNAME,		ROBOT_PRIORITY,			1 },
+	{ DRIVETRAIN_TASKNAME,	DRIVETRAIN_PRIORITY,	1 },
+	{ EXECUTOR_TASKNAME,	EXECUTOR_PRIORITY,		1 },
+	{ CHEEZY_TASKNAME,		CHEEZY_PRIORITY,		1 },
+	{ GYRO_TASKNAME,		GYRO_PRIORITY,			1 },
+	{ AUTONOMOUS_TASKNAME,	AUTONOMOUS_PRIORITY,	1 },
+	{ AUTOEXEC_TASKNAME,	AUTOEXEC_PRIORITY,		1 },
+	{ ARM_TASKNAME,			ARM_PRIORITY,			1 },
+	{ TAIL_TASKNAME,		TAIL_PRIORITY,			1 },
+	{ SHOOTER_TASKNAME,		SHOOTER_PRIORITY,		1 },
+	{ HANGER_TASKNAME,		HANGER_PRIORITY,		1 },
+	{ SHOOTER_SEQ_TASKNAME,	SEQUENCE_PRIORITY,		1 },
+	{ HANGER_SEQ_TASKNAME,	SEQUENCE_PRIORITY,		1 },
+	{ COMPONENT_TASKNAME,	COMPONENT_PRIORITY,		-1 },
+	{ PIXY_TASKNAME,		PIXY_PRIORITY,			0 },
+	{ FLIGHT_LOG_TASKNAME,	FLIGHT_LOG_PRIORITY,	0 },
+	{ REPLAY_TASKNAME,		REPLAY_PRIORITY,		0 },
+	{ "tTalon*",			TALON_PRIORITY,			0 },
+};
+
+//how many driver station packets after Init() to wait before reporting what the threads got
+const int THREAD_REPORT_LOOP = 100;
 //Queue Names - Used when you want to open the message queue for any task
 //NOTE: 2015 - we use pipes instead of queues
+//NOTE: 2016 - we use in-process mailboxes (see MessageQueue.h), the names are only used to find them
 //EXAMPLE: const char* DRIVETRAIN_TASKNAME = "tDrive";
 const char* const COMPONENT_QUEUE 	= "/tmp/qComp";
 const char* const DRIVETRAIN_QUEUE 	= "/tmp/qDrive";
@@ -68,6 +165,39 @@ const char* const ARM_QUEUE 	= "/tmp/qArm";
 const char* const TAIL_QUEUE 	= "/tmp/qTail";
 const char* const SHOOTER_QUEUE 	= "/tmp/qShooter";
 const char* const HANGER_QUEUE 	= "/tmp/qHanger";
+const char* const FLIGHT_REPLAY_QUEUE	= "/tmp/qReplay";	// replies to replayed commands
+
+//Queue Overflow - What Send() does when a component's mailbox lane is full (see MESSAGE_OVERFLOW).
+//Anything but BLOCK loses a message instead of stalling the sender, which is usually the driver
+//station loop.  The high lane carries state changes and autonomous responses, so it keeps
+//blocking, a slow receiver there is a bug we want to see.  Queues not listed get the defaults.
+struct QueueParams {
+	const char *szQueueName;
+	int iOverflow;
+	int iHighOverflow;
+};
+
+const int QUEUE_OVERFLOW		= MESSAGE_OVERFLOW_DROP_OLDEST;
+const int QUEUE_HIGH_OVERFLOW	= MESSAGE_OVERFLOW_BLOCK;
+
+const QueueParams QUEUE_PARAMS[] = {
+	{ DRIVETRAIN_QUEUE,	MESSAGE_OVERFLOW_BLOCK,			MESSAGE_OVERFLOW_BLOCK },	// never lose a stop, turn or move
+	{ SHOOTER_QUEUE,	MESSAGE_OVERFLOW_DROP_NEWEST,	MESSAGE_OVERFLOW_BLOCK },	// busy shooting, ignore more shots
+};
+
+//Message Tracing - When on, every message carries its send time and components keep histograms
+//of how long each command waited and how long it took to handle.  The histograms are appended
+//to MESSAGE_TRACE_FILE (%s is the component name) at the end of each match and on request.
+const bool MESSAGE_TRACING = true;
+const char* const MESSAGE_TRACE_FILE = ROBOT_HOME_DIR "trace_%s.txt";
+
+//Flight Log - When on, every message sent to any component is recorded to FLIGHT_LOG_FILE (%s is
+//the date and time the robot code started), see FlightLog.h.  In test mode the "replay" button
+//plays FLIGHT_REPLAY_FILE back into the "replay queue" at "replay speed" (0 is flat out).
+const bool FLIGHT_LOG = true;
+const char* const FLIGHT_LOG_FILE = ROBOT_HOME_DIR "flight_%s.bin";
+const char* const FLIGHT_REPLAY_FILE = ROBOT_HOME_DIR "replay.bin";
+const float FLIGHT_LOG_FLUSH_PERIOD = 0.25;
 
 //PWM Channels - Assigns names to PWM ports 1-10 on the Roborio
 //EXAMPLE: const int PWM_DRIVETRAIN_FRONT_LEFT_MOTOR = 1;
@@ -6,24 +6,36 @@
  */
 
 #include "RobotSequence.h"
-#include <unistd.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
+#include "MessageQueue.h"
+#include "MessageBus.h"
 
 RobotSequence* RobotSequence::pInstance;
 RobotSequence::RobotSequence(const char* const task) {
 	pTask = NULL;
 	bSequenceRunning = false;
+	bSequenceCancelled = false;
 	taskname = task;
+
+	MessageBus::Subscribe(MESSAGE_TOPIC_ROBOT_STATE, &RobotSequence::OnStateChange, this);
 }
 
 RobotSequence::~RobotSequence() {
+	MessageBus::Unsubscribe(MESSAGE_TOPIC_ROBOT_STATE, this);
+}
 
+void RobotSequence::OnStateChange(void *pThis, const RobotMessage *pMessage){
+	// a sequence that is still waiting must not fire the rest of its
+	// commands after the robot has been disabled or changed modes
+
+	if(((RobotSequence *)pThis)->bSequenceRunning)
+	{
+		((RobotSequence *)pThis)->bSequenceCancelled = true;
+	}
 }
 
 void RobotSequence::StartSequence(){
 	if(bSequenceRunning)return;
+	bSequenceCancelled = false;
 	printf("started sequence\n");
 	pTask = new Task(taskname, &RobotSequence::StartTask, this);
 	wpi_assert(pTask);
@@ -31,11 +43,15 @@ void RobotSequence::StartSequence(){
 
 void RobotSequence::SendMessage(const char* szQueueName, RobotMessage* message){
 
-	int iPipeXmt;
+	MessageQueue *pQueueXmt;
+
+	if(bSequenceCancelled)
+	{
+		return;
+	}
 
-	iPipeXmt = open(szQueueName, O_WRONLY);
-	wpi_assert(iPipeXmt > 0);
+	pQueueXmt = MessageQueue::GetEndpoint(szQueueName);
+	wpi_assert(pQueueXmt);
 
-	write(iPipeXmt, (char*) message, sizeof(RobotMessage));
-	close(iPipeXmt);
+	pQueueXmt->Send(message);
 }
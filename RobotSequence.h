@@ -9,6 +9,9 @@
 #define ROBOTSEQUENCE_H_
 #include "WPILib.h"
 #include "RobotMessage.h"
+#include "RobotParams.h"
+#include "ThreadConfig.h"
+#include <atomic>
 
 class RobotSequence {
 public:
@@ -16,9 +19,11 @@ public:
 	virtual ~RobotSequence();
 	virtual void Run()=0;
 	bool IsRunning(){return bSequenceRunning;}
+	bool IsCancelled(){return bSequenceCancelled;}
 
 	static void *StartTask(void *pThis)
 	{
+		ThreadConfig::Apply(((RobotSequence *)pThis)->taskname, SEQUENCE_PRIORITY);
 		pInstance = ((RobotSequence *)pThis);
 		pInstance->bSequenceRunning = true;
 		((RobotSequence *)pThis)->Run();
@@ -30,10 +35,12 @@ public:
 	static RobotSequence* GetInstance(){
 		return pInstance;
 	}
+	static void OnStateChange(void *pThis, const RobotMessage *pMessage);
 private:
 	static RobotSequence* pInstance;
 
 	bool bSequenceRunning;
+	std::atomic<bool> bSequenceCancelled;
 	Task* pTask;
 	const char* taskname;
 
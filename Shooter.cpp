@@ -8,7 +8,7 @@
 #include "Shooter.h"
 #include <RobotParams.h>
 #include "Arm.h"
-Shooter::Shooter() : ComponentBase(SHOOTER_TASKNAME, SHOOTER_QUEUE, SHOOTER_PRIORITY){
+Shooter::Shooter() : ComponentBase(SHOOTER_TASKNAME, SHOOTER_QUEUE, SHOOTER_PRIORITY, SHOOTER_TICK_PERIOD){
 
 	shooters = new ShooterSolenoid(CAN_PCM_SHOOTER);
 	jaw = new JawSolenoid(CAN_PCM_JAW);
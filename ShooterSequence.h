@@ -18,10 +18,10 @@ public:
 	virtual ~ShooterSequence();
 	void Run();
 private:
-	const float armDelay = 1.0f;
-	const float rotateBack = 0.2;  // wait and rotate the intake
-	const float preShootDelay = 1.0;
-	const float postShootDelay = 0.5;
+	const float armDelay = SHOOTER_SEQUENCE_ARM_DELAY;
+	const float rotateBack = SHOOTER_SEQUENCE_ROTATE_BACK;  // wait and rotate the intake
+	const float preShootDelay = SHOOTER_SEQUENCE_PRE_SHOOT;
+	const float postShootDelay = SHOOTER_SEQUENCE_POST_SHOOT;
 	const float clawCloseDelay = 0.5;
 };
 
@@ -8,7 +8,7 @@
 #include <Tail.h>
 #include <RobotParams.h>
 
-Tail::Tail() : ComponentBase(TAIL_TASKNAME, TAIL_QUEUE, TAIL_PRIORITY){
+Tail::Tail() : ComponentBase(TAIL_TASKNAME, TAIL_QUEUE, TAIL_PRIORITY, TAIL_TICK_PERIOD){
 	pTailTimer = new Timer();
 	pTailTimer->Stop();
 	pTailTimer->Reset();
@@ -0,0 +1,140 @@
+/** \file
+ * Applies real-time priorities and CPU placement to our threads.
+ *
+ * Everything here uses the kernel thread id rather than a pthread_t, so the
+ * report can safely look at a thread that has since exited, the kernel just
+ * says it is gone.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <ThreadConfig.h>
+
+std::mutex ThreadConfig::mutexThreads;
+std::vector<ThreadConfig::ThreadRecord> ThreadConfig::threads;
+
+const ThreadParams *ThreadConfig::Find(const char *szTaskName)
+{
+	for(unsigned i = 0; i < sizeof(THREAD_PARAMS) / sizeof(THREAD_PARAMS[0]); ++i)
+	{
+		const char *szName = THREAD_PARAMS[i].szName;
+		size_t length = strlen(szName);
+
+		// a trailing '*' matches any suffix, like the numbered talon monitors
+
+		if((length > 0) && (szName[length - 1] == '*'))
+		{
+			if(strncmp(szName, szTaskName, length - 1) == 0)
+			{
+				return(&THREAD_PARAMS[i]);
+			}
+		}
+		else if(strcmp(szName, szTaskName) == 0)
+		{
+			return(&THREAD_PARAMS[i]);
+		}
+	}
+
+	return(NULL);
+}
+
+void ThreadConfig::Apply(const char *szTaskName, int iDefaultPriority)
+{
+	const ThreadParams *pParams = Find(szTaskName);
+	ThreadRecord record;
+	struct sched_param param;
+	cpu_set_t mask;
+	char szThreadName[16];
+	int iPolicy;
+	int iError;
+
+	record.taskName = szTaskName;
+	record.tid = (pid_t)syscall(SYS_gettid);
+	record.iPriority = pParams ? pParams->iPriority : iDefaultPriority;
+	record.iCpu = pParams ? pParams->iCpu : -1;
+
+	// the kernel only keeps 15 characters, enough for ps and top to show it
+
+	strncpy(szThreadName, szTaskName, sizeof(szThreadName) - 1);
+	szThreadName[sizeof(szThreadName) - 1] = '\0';
+	pthread_setname_np(pthread_self(), szThreadName);
+
+	if(record.iCpu >= 0)
+	{
+		CPU_ZERO(&mask);
+		CPU_SET(record.iCpu, &mask);
+
+		if(sched_setaffinity(0, sizeof(mask), &mask) != 0)
+		{
+			printf("%s: unable to move to cpu %d, %s\n", szTaskName, record.iCpu, strerror(errno));
+		}
+	}
+
+	iPolicy = (record.iPriority > 0) ? SCHED_FIFO : SCHED_OTHER;
+	param.sched_priority = (record.iPriority > 0) ? record.iPriority : 0;
+	iError = pthread_setschedparam(pthread_self(), iPolicy, &param);
+
+	if(iError != 0)
+	{
+		printf("%s: unable to set priority %d, %s\n", szTaskName, record.iPriority, strerror(iError));
+	}
+
+	std::lock_guard<std::mutex> sync(mutexThreads);
+	threads.push_back(record);
+}
+
+void ThreadConfig::Report()
+{
+	std::lock_guard<std::mutex> sync(mutexThreads);
+	struct sched_param param;
+	cpu_set_t mask;
+	char szCpus[32];
+	int iPolicy;
+	int iPriority;
+	bool bMatch;
+
+	printf("%-14s %6s   %-14s   %s\n", "thread", "tid", "wanted", "running");
+
+	for(unsigned i = 0; i < threads.size(); ++i)
+	{
+		ThreadRecord *pRecord = &threads[i];
+
+		iPolicy = sched_getscheduler(pRecord->tid);
+
+		if((iPolicy < 0) || (sched_getparam(pRecord->tid, &param) != 0) ||
+				(sched_getaffinity(pRecord->tid, sizeof(mask), &mask) != 0))
+		{
+			printf("%-14s %6d %14s\n", pRecord->taskName.c_str(), pRecord->tid, "exited");
+			continue;
+		}
+
+		iPriority = (iPolicy == SCHED_FIFO) ? param.sched_priority : 0;
+		szCpus[0] = '\0';
+
+		for(int iCpu = 0; (iCpu < CPU_SETSIZE) && (strlen(szCpus) < sizeof(szCpus) - 4); ++iCpu)
+		{
+			if(CPU_ISSET(iCpu, &mask))
+			{
+				snprintf(szCpus + strlen(szCpus), sizeof(szCpus) - strlen(szCpus), "%s%d",
+						szCpus[0] ? "," : "", iCpu);
+			}
+		}
+
+		// a host without the CPU asked for always mismatches, see ThreadConfig.h
+
+		bMatch = (iPriority == ((pRecord->iPriority > 0) ? pRecord->iPriority : 0)) &&
+				((pRecord->iCpu < 0) || ((CPU_COUNT(&mask) == 1) && CPU_ISSET(pRecord->iCpu, &mask)));
+
+		printf("%-14s %6d   %s %2d cpu %2d   %s %2d cpu %s%s\n",
+				pRecord->taskName.c_str(), pRecord->tid,
+				(pRecord->iPriority > 0) ? "FIFO " : "OTHER", pRecord->iPriority, pRecord->iCpu,
+				(iPolicy == SCHED_FIFO) ? "FIFO " : "OTHER", iPriority, szCpus,
+				bMatch ? "" : "  <-- MISMATCH");
+	}
+}
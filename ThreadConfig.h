@@ -0,0 +1,52 @@
+/** \file
+ * Applies real-time priorities and CPU placement to our threads.
+ *
+ * WPILib's Task starts every thread with whatever the creator had, so each of
+ * our threads calls ThreadConfig::Apply() with its task name as the first thing
+ * it does.  The name is looked up in THREAD_PARAMS (RobotParams.h) and the
+ * thread switches itself to SCHED_FIFO at that priority and moves to that CPU.
+ * Threads that are not in the table get the priority the caller passes as a
+ * default, usually the one the task was created with, and stay on any CPU.
+ *
+ * Every thread that applied its settings is remembered, and Report() asks the
+ * kernel what each one is really running with so a missing rtprio limit or a
+ * typo in the table shows up on the console instead of as a slow robot.
+ *
+ * Expect MISMATCH on a host that is not the roboRIO.  A machine with a single
+ * CPU has no CPU 1 to pin the control loops to, so they stay on the CPU they
+ * started on, and without root or an rtprio limit every thread stays in the
+ * normal time shared class.  The robot still runs, just without the placement.
+ */
+
+#ifndef THREAD_CONFIG_H
+#define THREAD_CONFIG_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+//Robot
+#include <RobotParams.h>
+
+class ThreadConfig
+{
+public:
+	static void Apply(const char *szTaskName, int iDefaultPriority = 0);
+	static void Report();
+
+private:
+	struct ThreadRecord {
+		std::string taskName;
+		pid_t tid;
+		int iPriority;				// what we asked for
+		int iCpu;
+	};
+
+	static std::mutex mutexThreads;
+	static std::vector<ThreadRecord> threads;
+
+	static const ThreadParams *Find(const char *szTaskName);
+};
+
+#endif //THREAD_CONFIG_H
@@ -0,0 +1,284 @@
+/** \file
+ * CPU use and tick jitter of one task per component against a single
+ * ComponentExecutor style task that steps every component in turn.
+ *
+ * Six fake components stand in for the robot's: a drivetrain ticked every 10ms,
+ * a tail every 20ms, a shooter and hanger every 50ms, and an arm and autonomous
+ * that only react to messages.  Every step and every message costs about 20us
+ * of spinning.  A sender thread plays the driver station, sending a drive
+ * command and an arm command every 20ms.
+ *
+ * Threaded mode gives every component its own thread, a PeriodicTimer for the
+ * ticked ones and a blocking Receive() for the rest, the way ComponentBase does
+ * without EXECUTOR_MODE.  Executor mode runs them all from one 10ms tick.
+ * Reported are process CPU time, context switches, the tick jitter and the
+ * time from a message being sent to it being handled.
+ *
+ * This does not need WPILib and runs on any Linux box:
+ * \verbatim
+   g++ -std=c++11 -O2 -I. bench/ExecutorBench.cpp MessageQueue.cpp PeriodicTimer.cpp RobotClock.cpp -o execbench -lpthread
+   ./execbench [seconds]
+   \endverbatim
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+//Robot
+#include <MessageQueue.h>
+#include <PeriodicTimer.h>
+
+const float BENCH_EXECUTOR_PERIOD = 0.010;
+const float BENCH_SENDER_PERIOD = 0.020;
+const unsigned BENCH_WORK_US = 20;
+
+struct FakeComponent {
+	const char *szName;
+	float fTickPeriod;				// 0.0 when only driven by messages
+	MessageQueue *pQueue;
+	PeriodicTimer *pTimer;			// threaded mode only
+	std::vector<long long> latency;	// send to handled, microseconds
+	unsigned uSteps;
+};
+
+static std::atomic<bool> bRunning;
+
+static void Spin(unsigned uMicroseconds)
+{
+	long long llEnd = PeriodicTimer::NowUs() + uMicroseconds;
+
+	while(PeriodicTimer::NowUs() < llEnd)
+	{
+		// intentionally empty
+	}
+}
+
+static void Handle(FakeComponent *pComponent, const RobotMessage *pMessage)
+{
+	pComponent->latency.push_back(MessageQueue::GetTraceTimeUs() - pMessage->trace.llSentUs);
+	Spin(BENCH_WORK_US);
+}
+
+///what ComponentBase::Step() does, drain the mailbox then do the periodic work
+static void Step(FakeComponent *pComponent)
+{
+	RobotMessage message;
+
+	while(pComponent->pQueue->TryReceive(&message))
+	{
+		Handle(pComponent, &message);
+	}
+
+	if(pComponent->fTickPeriod > 0.0)
+	{
+		Spin(BENCH_WORK_US);
+	}
+
+	pComponent->uSteps++;
+}
+
+static void ThreadedComponent(FakeComponent *pComponent)
+{
+	RobotMessage message;
+
+	if(pComponent->fTickPeriod > 0.0)
+	{
+		pComponent->pTimer->Start();
+
+		while(bRunning.load())
+		{
+			pComponent->pTimer->WaitForNextTick();
+			Step(pComponent);
+		}
+	}
+	else
+	{
+		while(bRunning.load())
+		{
+			if(pComponent->pQueue->Receive(&message, 100000))
+			{
+				Handle(pComponent, &message);
+			}
+		}
+	}
+}
+
+static void Executor(std::vector<FakeComponent> *pComponents, PeriodicTimer *pTimer)
+{
+	std::vector<unsigned> dividers;
+	unsigned uTick = 0;
+
+	for(unsigned i = 0; i < pComponents->size(); ++i)
+	{
+		float fTickPeriod = (*pComponents)[i].fTickPeriod;
+
+		dividers.push_back((fTickPeriod > pTimer->GetPeriod()) ?
+				(unsigned)(fTickPeriod / pTimer->GetPeriod() + 0.5) : 1);
+	}
+
+	pTimer->Start();
+
+	while(bRunning.load())
+	{
+		pTimer->WaitForNextTick();
+
+		for(unsigned i = 0; i < pComponents->size(); ++i)
+		{
+			if((uTick % dividers[i]) == 0)
+			{
+				Step(&(*pComponents)[i]);
+			}
+		}
+
+		uTick++;
+	}
+}
+
+static void DriverStation(MessageQueue *pDrive, MessageQueue *pArm)
+{
+	PeriodicTimer timer(BENCH_SENDER_PERIOD);
+	RobotMessage message;
+
+	timer.Start();
+
+	while(bRunning.load())
+	{
+		timer.WaitForNextTick();
+
+		message.command = COMMAND_DRIVETRAIN_DRIVE_CHEEZY;
+		GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(message).wheel = 0.1;
+		pDrive->Send(&message);
+
+		message.command = COMMAND_ARM_INTAKE;
+		pArm->Send(&message);
+	}
+}
+
+static long long CpuUs()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+	return((long long)now.tv_sec * 1000000LL + now.tv_nsec / 1000);
+}
+
+static long ContextSwitches()
+{
+	struct rusage usage;
+
+	getrusage(RUSAGE_SELF, &usage);
+	return(usage.ru_nvcsw + usage.ru_nivcsw);
+}
+
+static void Run(bool bExecutor, int iSeconds)
+{
+	const char *szNames[] = { "auto", "drive", "arm", "tail", "shooter", "hanger" };
+	const float fPeriods[] = { 0.0, 0.010, 0.0, 0.020, 0.050, 0.050 };
+	std::vector<FakeComponent> components(6);
+	std::vector<std::thread> threads;
+	PeriodicTimer executorTimer(BENCH_EXECUTOR_PERIOD);
+	std::vector<long long> latency;
+	long long llCpuStart;
+	long llSwitchesStart;
+	float fJitterMax = 0.0;
+	float fJitterAvg = 0.0;
+	unsigned uOverruns = 0;
+	unsigned uTicked = 0;
+
+	for(unsigned i = 0; i < components.size(); ++i)
+	{
+		components[i].szName = szNames[i];
+		components[i].fTickPeriod = fPeriods[i];
+		components[i].pQueue = new MessageQueue(szNames[i]);
+		components[i].pTimer = (fPeriods[i] > 0.0) ? new PeriodicTimer(fPeriods[i]) : NULL;
+		components[i].uSteps = 0;
+	}
+
+	bRunning.store(true);
+	llCpuStart = CpuUs();
+	llSwitchesStart = ContextSwitches();
+
+	if(bExecutor)
+	{
+		threads.push_back(std::thread(Executor, &components, &executorTimer));
+	}
+	else
+	{
+		for(unsigned i = 0; i < components.size(); ++i)
+		{
+			threads.push_back(std::thread(ThreadedComponent, &components[i]));
+		}
+	}
+
+	threads.push_back(std::thread(DriverStation, components[1].pQueue, components[2].pQueue));
+
+	std::this_thread::sleep_for(std::chrono::seconds(iSeconds));
+	bRunning.store(false);
+
+	for(unsigned i = 0; i < threads.size(); ++i)
+	{
+		threads[i].join();
+	}
+
+	if(bExecutor)
+	{
+		fJitterMax = executorTimer.GetJitterMax();
+		fJitterAvg = executorTimer.GetJitterAvg();
+		uOverruns = executorTimer.GetOverruns();
+	}
+	else
+	{
+		for(unsigned i = 0; i < components.size(); ++i)
+		{
+			if(components[i].pTimer)
+			{
+				fJitterMax = std::max(fJitterMax, components[i].pTimer->GetJitterMax());
+				fJitterAvg += components[i].pTimer->GetJitterAvg();
+				uOverruns += components[i].pTimer->GetOverruns();
+				uTicked++;
+			}
+		}
+
+		fJitterAvg /= uTicked;
+	}
+
+	for(unsigned i = 0; i < components.size(); ++i)
+	{
+		latency.insert(latency.end(), components[i].latency.begin(), components[i].latency.end());
+	}
+
+	std::sort(latency.begin(), latency.end());
+
+	printf("%-9s cpu %5.2f%%  switches/s %6.0f  jitter avg %6.1fus max %6.0fus  overruns %u  "
+			"latency p50 %5lldus p99 %5lldus max %5lldus\n",
+			bExecutor ? "executor" : "threaded",
+			100.0 * (CpuUs() - llCpuStart) / (iSeconds * 1000000.0),
+			(float)(ContextSwitches() - llSwitchesStart) / iSeconds,
+			fJitterAvg, fJitterMax, uOverruns,
+			latency.empty() ? 0 : latency[latency.size() / 2],
+			latency.empty() ? 0 : latency[latency.size() * 99 / 100],
+			latency.empty() ? 0 : latency.back());
+
+	for(unsigned i = 0; i < components.size(); ++i)
+	{
+		delete components[i].pQueue;
+		delete components[i].pTimer;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int iSeconds = (argc > 1) ? atoi(argv[1]) : 5;
+
+	MessageQueue::SetTracing(true);
+
+	Run(false, iSeconds);
+	Run(true, iSeconds);
+	return(0);
+}
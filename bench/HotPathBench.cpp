@@ -0,0 +1,701 @@
+/** \file
+ * Repeatable timings of the robot's hot paths, one JSON object per line.
+ *
+ * Each benchmark calls one piece of robot code in a tight loop:
+ *  - component.*: a message sent to a do-nothing component and handled by
+ *    ComponentBase::Step(), through the normal lane and a latest-value slot
+ *  - autonomous.*: a script decoded line by line as it runs with Evaluate(),
+ *    compiled with AutoCompileLine(), and run compiled with Execute(), then
+ *    a single MOVE both ways; stand-in components answer each command at once
+ *  - cheezy.*: CheezyLoop::Update() and one CheezyLoop::Iterate(), which is
+ *    one call of CheezyIterate1296()
+ *  - gyro.update_data: one ADXRS453Z::UpdateData() integration step
+ *  - pixy.parse_frame: a three block PixyCam frame through ParseWord()
+ *  - drivetrain.run/<command>: that command sent to Drivetrain and handled by
+ *    Step(), for every command Drivetrain::Run() handles except
+ *    COMMAND_AUTONOMOUS_SHOOT, which always takes more than two seconds, and
+ *    the measured moves (MSTRAIGHT, MLINE), which drive until they get there.
+ *    AUTO_MOVE, STRAIGHT and TURN are sent with the sim in autonomous, they
+ *    do nothing otherwise; everything else runs disabled
+ *
+ * Every group runs in a child process of its own with a fresh robot, so one
+ * group's leftovers (queues, half finished moves) cannot skew the next.  The
+ * drivetrain builds a fresh Drivetrain for every command.  Components run in
+ * executor mode, so the benchmark thread is the one that calls Step(); the
+ * tasks the hardware classes start for themselves (gyro, cheezy loop, talon
+ * monitors) keep running in the background, as they would on the robot.
+ *
+ * A benchmark warms up, then times its loop BENCH_REPETITIONS times.  The
+ * median of those is reported as ns_per_op along with the fastest and the
+ * slowest, and the median thread CPU time per op (which leaves out waiting,
+ * the part that matters for whole autonomous scripts).  -c compares the fastest
+ * repetitions, they move the least when something else wakes up on the box.
+ *
+ * It builds against the host simulation in sim/, without RhsRobot.cpp (that
+ * is where the robot's main() comes from).  The numbers are host numbers: the
+ * device classes, the dashboard and the cheezy stand-in are sim/'s, so only
+ * compare runs from the same machine.  Keep the results of every commit in
+ * one file and compare the latest run against it:
+ * \verbatim
+   g++ -std=c++14 -O2 -Isim/include -I. -DROBOT_HOME_DIR='"sim_home/"' bench/HotPathBench.cpp $(ls *.cpp | grep -v '^RhsRobot.cpp$') sim/SimWorld.cpp sim/SimHal.cpp sim/cheezy/frc1296.cpp -o hotbench -lpthread
+   ./hotbench -r $(git rev-parse --short HEAD) -c hotpath.jsonl -o hotpath.jsonl
+   \endverbatim
+ * Options:
+ *  -r name		revision to record with every result, default "unknown"
+ *  -o file		append the results to this file as well as printing them
+ *  -c file		compare ns_min against the latest result for each benchmark in
+ *  			this file, exit with 1 if any got slower by more than -l percent
+ *  -l percent	regression limit for -c, default 10
+ *  -f text		only run benchmarks with this in their name
+ *  -s file		script for autonomous.*, default RhsScript.txt
+ *  -x scale	multiply every iteration count, default 1
+ *  -v			let the robot code print, normally it goes to /dev/null
+ */
+
+#include <algorithm>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+//Robot
+#include <WPILib.h>
+#include <ComponentBase.h>
+#include <CommandTraits.h>
+#include <Autonomous.h>
+#include <Drivetrain.h>
+#include <ADXRS453Z.h>
+#include <PixyCam.h>
+#include <RobotParams.h>
+
+const unsigned BENCH_REPETITIONS = 7;
+const char* const BENCH_QUEUE = "/tmp/qBench";
+const char* const BENCH_REPLY_QUEUE = "/tmp/qBenchReply";
+const int BENCH_RESPONDER_TIMEOUT_US = 100000;
+
+static const char *szRevision = "unknown";
+static const char *szFilter = NULL;
+static const char *szScriptFile = "RhsScript.txt";
+static float fScale = 1.0;
+static bool bVerbose = false;
+static int iResultFd = -1;				// the child writes its results here
+
+static long long NowNs()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return((long long)now.tv_sec * 1000000000LL + now.tv_nsec);
+}
+
+static long long ThreadCpuNs()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+	return((long long)now.tv_sec * 1000000000LL + now.tv_nsec);
+}
+
+static bool Wanted(const std::string &name)
+{
+	return((szFilter == NULL) || (name.find(szFilter) != std::string::npos));
+}
+
+///times uIterations calls of op, BENCH_REPETITIONS times, and reports one JSON line
+template<typename Op>
+static void Measure(const std::string &name, unsigned uIterations, Op op)
+{
+	std::vector<double> wall;
+	std::vector<double> cpu;
+	long long llStartNs;
+	long long llCpuStartNs;
+	char szLine[512];
+	int iLength;
+
+	if(!Wanted(name))
+	{
+		return;
+	}
+
+	uIterations = std::max(1u, (unsigned)(uIterations * fScale));
+
+	for(unsigned i = 0; i < uIterations / 10 + 1; ++i)
+	{
+		op();
+	}
+
+	for(unsigned uRep = 0; uRep < BENCH_REPETITIONS; ++uRep)
+	{
+		llStartNs = NowNs();
+		llCpuStartNs = ThreadCpuNs();
+
+		for(unsigned i = 0; i < uIterations; ++i)
+		{
+			op();
+		}
+
+		cpu.push_back((double)(ThreadCpuNs() - llCpuStartNs) / uIterations);
+		wall.push_back((double)(NowNs() - llStartNs) / uIterations);
+	}
+
+	std::sort(wall.begin(), wall.end());
+	std::sort(cpu.begin(), cpu.end());
+
+	iLength = snprintf(szLine, sizeof(szLine),
+			"{\"bench\":\"%s\",\"revision\":\"%s\",\"iterations\":%u,\"reps\":%u,"
+			"\"ns_per_op\":%.1f,\"ns_min\":%.1f,\"ns_max\":%.1f,\"cpu_ns_per_op\":%.1f}\n",
+			name.c_str(), szRevision, uIterations, BENCH_REPETITIONS,
+			wall[BENCH_REPETITIONS / 2], wall.front(), wall.back(), cpu[BENCH_REPETITIONS / 2]);
+
+	if(write(iResultFd, szLine, iLength) != iLength)
+	{
+		perror("hotbench: result pipe");
+	}
+}
+
+///ISAUTO and friends need a robot to ask, it is disabled unless SimWorld::SetMode() says otherwise
+class BenchRobot : public RobotBase
+{
+public:
+	void StartCompetition() {}
+};
+
+///the least a component can do, so what is left is ComponentBase's own cost
+class BenchComponent : public ComponentBase
+{
+public:
+	BenchComponent() : ComponentBase(COMPONENT_TASKNAME, BENCH_QUEUE, COMPONENT_PRIORITY) {};
+
+private:
+	void OnStateChange() {};
+	void Run() {};
+};
+
+///Evaluate() and Execute() are protected, and the script must not wait for a state change
+class BenchAutonomous : public Autonomous
+{
+public:
+	BenchAutonomous() { bPauseAutoMode = false; };
+
+	using Autonomous::Evaluate;
+	using Autonomous::Execute;
+};
+
+///stands in for a component: answers everything that wants an answer, at once
+static void Responder(MessageQueue *pQueue)
+{
+	RobotMessage batch[MESSAGE_BATCH_SIZE];
+	RobotMessage reply;
+	unsigned uCount;
+
+	reply.command = COMMAND_AUTONOMOUS_RESPONSE_OK;
+	reply.replyQ = NULL;
+
+	while(true)
+	{
+		uCount = pQueue->ReceiveBatch(batch, MESSAGE_BATCH_SIZE, BENCH_RESPONDER_TIMEOUT_US);
+
+		for(unsigned i = 0; i < uCount; ++i)
+		{
+			if((batch[i].uCorrelation != CORRELATION_NONE) && (batch[i].replyQ != NULL))
+			{
+				reply.uCorrelation = batch[i].uCorrelation;
+				MessageQueue::GetEndpoint(batch[i].replyQ)->Send(&reply);
+			}
+		}
+	}
+}
+
+static void BenchComponents()
+{
+	BenchComponent component;
+	RobotMessage message;
+
+	message.replyQ = NULL;
+	message.uCorrelation = CORRELATION_NONE;
+
+	message.command = COMMAND_COMPONENT_TEST;
+	Measure("component.send_step", 100000, [&]() {
+		component.SendMessage(&message);
+		component.Step();
+	});
+
+	Measure("component.send_step_batch", 10000, [&]() {
+		for(unsigned i = 0; i < MESSAGE_BATCH_SIZE; ++i)
+		{
+			component.SendMessage(&message);
+		}
+
+		component.Step();
+	});
+
+	SetCommand<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(message).wheel = 0.2;
+	GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(message).throttle = 0.5;
+	GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(message).bQuickturn = false;
+	Measure("component.send_step_slot", 100000, [&]() {
+		component.SendMessage(&message);
+		component.Step();
+	});
+}
+
+static void BenchAutonomousScript()
+{
+	const char *szComponentQueues[] = { DRIVETRAIN_QUEUE, ARM_QUEUE, TAIL_QUEUE, SHOOTER_QUEUE, HANGER_QUEUE };
+	std::vector<std::string> script;
+	std::ifstream scriptStream(szScriptFile);
+	std::string line;
+
+	if(!scriptStream.is_open())
+	{
+		fprintf(stderr, "hotbench: no script %s, autonomous.* skipped\n", szScriptFile);
+		return;
+	}
+
+	while(std::getline(scriptStream, line))
+	{
+		script.push_back(line);
+	}
+
+	for(const char *szQueue : szComponentQueues)
+	{
+		std::thread(Responder, new MessageQueue(szQueue)).detach();
+	}
+
+	BenchAutonomous *pAuto = new BenchAutonomous();
+	std::string scriptName = basename(szScriptFile);
+	std::vector<AutoInstruction> program;
+	AutoInstruction instruction;
+	std::string moveLine = "MOVE 0.5 0.5";
+	AutoInstruction move;
+
+	// one op is the whole script, up to the line that ends it, like DoScript()
+
+	Measure("autonomous.evaluate/" + scriptName, 200, [&]() {
+		for(const std::string &statement : script)
+		{
+			if(!statement.empty() && pAuto->Evaluate(statement))
+			{
+				break;
+			}
+		}
+	});
+
+	Measure("autonomous.compile/" + scriptName, 10000, [&]() {
+		program.clear();
+
+		for(unsigned i = 0; i < script.size(); ++i)
+		{
+			if(AutoCompileLine(script[i].c_str(), i, instruction))
+			{
+				program.push_back(instruction);
+			}
+		}
+	});
+
+	Measure("autonomous.execute/" + scriptName, 200, [&]() {
+		for(const AutoInstruction &compiled : program)
+		{
+			if(pAuto->Execute(compiled))
+			{
+				break;
+			}
+		}
+	});
+
+	// one instruction that only sends a message, decoded as it runs and decoded before
+
+	Measure("autonomous.evaluate_line/MOVE", 20000, [&]() {
+		pAuto->Evaluate(moveLine);
+	});
+
+	AutoCompileLine(moveLine.c_str(), 0, move);
+	Measure("autonomous.execute_line/MOVE", 20000, [&]() {
+		pAuto->Execute(move);
+	});
+}
+
+static void BenchCheezy()
+{
+	CheezyLoop cheezy(false);
+	DrivetrainGoal goal = {};
+	DrivetrainPosition position = {};
+	DrivetrainOutput output;
+	DrivetrainStatus status;
+
+	goal.steering = 0.2;
+	goal.throttle = 0.6;
+	position.battery_voltage = 12.5;
+
+	Measure("cheezy.update", 100000, [&]() {
+		position.left_encoder += 0.001;
+		position.right_encoder += 0.001;
+		cheezy.Update(goal, position, output, status, true);
+	});
+
+	Measure("cheezy.iterate", 100000, [&]() {
+		cheezy.Iterate();
+	});
+}
+
+static void BenchGyro()
+{
+	ADXRS453Z gyro(false);
+
+	gyro.Update();		// still warming up, this only reads a sample and starts the clock
+
+	Measure("gyro.update_data", 100000, [&]() {
+		gyro.UpdateData();
+	});
+}
+
+static void BenchPixy()
+{
+	PixyCam pixy(false);
+	std::vector<uint16_t> frame;
+	const uint16_t uBlocks[3][6] = {
+		{ 0x0123, 1, 180, 100, 40, 30 },		// checksum, signature, x, y, width, height
+		{ 0x0456, 1, 60, 120, 20, 16 },
+		{ 0x0789, 2, 300, 40, 8, 8 } };
+
+	// sync, sync, block, then sync sync before each block after the first,
+	// and a 0 for "no more blocks"
+
+	frame.push_back(PIXICOM_FRAMESYNCWORD);
+
+	for(const auto &block : uBlocks)
+	{
+		frame.push_back(PIXICOM_FRAMESYNCWORD);
+		frame.insert(frame.end(), block, block + 6);
+		frame.push_back(PIXICOM_FRAMESYNCWORD);
+	}
+
+	frame.push_back(0);
+
+	Measure("pixy.parse_frame", 100000, [&]() {
+		for(uint16_t uWord : frame)
+		{
+			pixy.ParseWord(uWord);
+		}
+	});
+}
+
+///the parameters of each command Drivetrain::Run() handles
+static void FillDrivetrainCommand(MessageCommand command, RobotMessage &message)
+{
+	message.command = command;
+	message.replyQ = BENCH_REPLY_QUEUE;
+	message.uCorrelation = 1;
+
+	switch(command)
+	{
+	case COMMAND_DRIVETRAIN_DRIVE_TANK:
+		SetCommand<COMMAND_DRIVETRAIN_DRIVE_TANK>(message) = { 0.5, 0.4 };
+		break;
+
+	case COMMAND_DRIVETRAIN_AUTO_MOVE:
+		SetCommand<COMMAND_DRIVETRAIN_AUTO_MOVE>(message) = { 0.5, 0.4 };
+		break;
+
+	case COMMAND_DRIVETRAIN_DRIVE_SPLITARCADE:
+		SetCommand<COMMAND_DRIVETRAIN_DRIVE_SPLITARCADE>(message) = { 0.2, 0.5, 0.0 };
+		break;
+
+	case COMMAND_DRIVETRAIN_DRIVE_CHEEZY:
+		SetCommand<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(message) = { 0.2, 0.5, false };
+		break;
+
+	case COMMAND_DRIVETRAIN_STRAIGHT:
+	case COMMAND_DRIVETRAIN_TURN:
+		memset(&message.params.autonomous, 0, sizeof(message.params.autonomous));
+		message.params.autonomous.driveSpeed = 0.4;
+		message.params.autonomous.driveDistance = 120.0;
+		message.params.autonomous.turnAngle = 90.0;
+		message.params.autonomous.timeout = 2.0;
+		break;
+
+	case COMMAND_SYSTEM_CONSTANTS:
+		SetCommand<COMMAND_SYSTEM_CONSTANTS>(message).fBattery = 12.5;
+		break;
+
+	case COMMAND_AUTONOMOUS_SEARCHGOAL:
+		SetCommand<COMMAND_AUTONOMOUS_SEARCHGOAL>(message).direction = true;
+		break;
+
+	default:
+		break;
+	}
+}
+
+static void BenchDrivetrain(MessageCommand command)
+{
+	MessageQueue replies(BENCH_REPLY_QUEUE);
+	RobotMessage batch[MESSAGE_BATCH_SIZE];
+	RobotMessage message;
+
+	Drivetrain *pDrivetrain = new Drivetrain();
+
+	FillDrivetrainCommand(command, message);
+
+	// the autonomous moves check ISAUTO before they touch a motor
+
+	switch(command)
+	{
+	case COMMAND_DRIVETRAIN_AUTO_MOVE:
+	case COMMAND_DRIVETRAIN_STRAIGHT:
+	case COMMAND_DRIVETRAIN_TURN:
+		SimWorld::SetMode(SIM_MODE_AUTONOMOUS);
+		break;
+
+	default:
+		break;
+	}
+
+	Measure(std::string("drivetrain.run/") + GetCommandName(command), 2000, [&]() {
+		pDrivetrain->SendMessage(&message);
+		pDrivetrain->Step();
+		replies.ReceiveBatch(batch, MESSAGE_BATCH_SIZE, 0);
+	});
+}
+
+///runs one group in a child process of its own, false if it did not finish
+static bool RunChild(void (*pGroup)(void *), void *pArgument, int iResultWriteFd)
+{
+	pid_t child = fork();
+	int iStatus;
+
+	if(child < 0)
+	{
+		perror("hotbench: fork");
+		return(false);
+	}
+
+	if(child == 0)
+	{
+		iResultFd = iResultWriteFd;
+
+		if(!bVerbose)
+		{
+			int iNull = open("/dev/null", O_WRONLY);
+			dup2(iNull, STDOUT_FILENO);
+			close(iNull);
+		}
+
+		ComponentBase::SetExecutorMode(true);
+		new BenchRobot();
+		pGroup(pArgument);
+		fflush(stdout);
+		_exit(0);				// the robot's tasks never stop, do not wait for them
+	}
+
+	if((waitpid(child, &iStatus, 0) < 0) || !WIFEXITED(iStatus) || (WEXITSTATUS(iStatus) != 0))
+	{
+		fprintf(stderr, "hotbench: a benchmark child died, status 0x%x\n", iStatus);
+		return(false);
+	}
+
+	return(true);
+}
+
+static void GroupComponents(void *) { BenchComponents(); }
+static void GroupCheezy(void *) { BenchCheezy(); }
+static void GroupGyro(void *) { BenchGyro(); }
+static void GroupPixy(void *) { BenchPixy(); }
+static void GroupDrivetrain(void *pCommand) { BenchDrivetrain(*(MessageCommand *)pCommand); }
+
+static void GroupAutonomous(void *)
+{
+	// the autonomous task has to be running to hand back the responses
+
+	ComponentBase::SetExecutorMode(false);
+	BenchAutonomousScript();
+}
+
+///the newest ns_min of every benchmark in a results file
+static std::map<std::string, double> LoadBaseline(const char *szFile)
+{
+	std::map<std::string, double> baseline;
+	std::ifstream file(szFile);
+	std::string line;
+	char szName[256];
+	double fNsMin;
+
+	while(std::getline(file, line))
+	{
+		const char *szStart = strstr(line.c_str(), "\"bench\":\"");
+		const char *szNs = strstr(line.c_str(), "\"ns_min\":");
+
+		if(szStart && szNs && (sscanf(szStart, "\"bench\":\"%255[^\"]\"", szName) == 1)
+				&& (sscanf(szNs, "\"ns_min\":%lf", &fNsMin) == 1))
+		{
+			baseline[szName] = fNsMin;
+		}
+	}
+
+	return(baseline);
+}
+
+///prints old against new, true if nothing got slower than the limit allows
+static bool Compare(const std::map<std::string, double> &baseline, const std::string &results, float fLimit)
+{
+	bool bPassed = true;
+	char szName[256];
+	double fNsMin;
+	size_t start = 0;
+	size_t end;
+
+	fprintf(stderr, "%-52s %12s %12s %8s\n", "benchmark", "baseline ns", "now ns", "change");
+
+	while((end = results.find('\n', start)) != std::string::npos)
+	{
+		std::string line = results.substr(start, end - start);
+		const char *szNs = strstr(line.c_str(), "\"ns_min\":");
+
+		start = end + 1;
+
+		if((szNs == NULL) || (sscanf(line.c_str(), "{\"bench\":\"%255[^\"]\"", szName) != 1) ||
+				(sscanf(szNs, "\"ns_min\":%lf", &fNsMin) != 1))
+		{
+			continue;
+		}
+
+		auto old = baseline.find(szName);
+
+		if(old == baseline.end())
+		{
+			fprintf(stderr, "%-52s %12s %12.1f %8s\n", szName, "-", fNsMin, "new");
+			continue;
+		}
+
+		float fChange = 100.0 * (fNsMin - old->second) / old->second;
+		bool bSlower = (fChange > fLimit);
+
+		fprintf(stderr, "%-52s %12.1f %12.1f %+7.1f%%%s\n", szName, old->second, fNsMin, fChange,
+				bSlower ? "  SLOWER" : "");
+		bPassed &= !bSlower;
+	}
+
+	return(bPassed);
+}
+
+static void Usage(const char *szName)
+{
+	fprintf(stderr, "usage: %s [-r revision] [-o file] [-c baseline] [-l percent] [-f filter] [-s script] [-x scale] [-v]\n",
+			szName);
+}
+
+int main(int argc, char **argv)
+{
+	const MessageCommand drivetrainCommands[] = {
+		COMMAND_DRIVETRAIN_DRIVE_TANK,
+		COMMAND_DRIVETRAIN_AUTO_MOVE,
+		COMMAND_DRIVETRAIN_SETANGLE,
+		COMMAND_DRIVETRAIN_DRIVE_SPLITARCADE,
+		COMMAND_DRIVETRAIN_DRIVE_CHEEZY,
+		COMMAND_DRIVETRAIN_STRAIGHT,
+		COMMAND_DRIVETRAIN_TURN,
+		COMMAND_DRIVETRAIN_STOP,
+		COMMAND_SYSTEM_CONSTANTS,
+		COMMAND_AUTONOMOUS_SEARCHGOAL,
+		COMMAND_AUTONOMOUS_SEARCHBALL,
+		COMMAND_DRIVETRAIN_REDSENSE,
+		COMMAND_SYSTEM_MSGTIMEOUT };
+	const char *szOutput = NULL;
+	const char *szBaseline = NULL;
+	float fLimit = 10.0;
+	int iPipe[2];
+	int iOption;
+	bool bFinished = true;
+	std::string results;
+	char buffer[4096];
+	ssize_t iRead;
+
+	while((iOption = getopt(argc, argv, "r:o:c:l:f:s:x:vh")) != -1)
+	{
+		switch(iOption)
+		{
+		case 'r': szRevision = optarg; break;
+		case 'o': szOutput = optarg; break;
+		case 'c': szBaseline = optarg; break;
+		case 'l': fLimit = atof(optarg); break;
+		case 'f': szFilter = optarg; break;
+		case 's': szScriptFile = optarg; break;
+		case 'x': fScale = atof(optarg); break;
+		case 'v': bVerbose = true; break;
+		default:
+			Usage(argv[0]);
+			return(2);
+		}
+	}
+
+	// read the baseline first, -c and -o may well be the same file
+
+	std::map<std::string, double> baseline;
+
+	if(szBaseline)
+	{
+		baseline = LoadBaseline(szBaseline);
+	}
+
+	if(pipe(iPipe) != 0)
+	{
+		perror("hotbench: pipe");
+		return(2);
+	}
+
+	// the results are small, the pipe holds a whole group's worth
+
+	bFinished &= RunChild(GroupComponents, NULL, iPipe[1]);
+	bFinished &= RunChild(GroupAutonomous, NULL, iPipe[1]);
+	bFinished &= RunChild(GroupCheezy, NULL, iPipe[1]);
+	bFinished &= RunChild(GroupGyro, NULL, iPipe[1]);
+	bFinished &= RunChild(GroupPixy, NULL, iPipe[1]);
+
+	for(MessageCommand command : drivetrainCommands)
+	{
+		if(Wanted(std::string("drivetrain.run/") + GetCommandName(command)))
+		{
+			bFinished &= RunChild(GroupDrivetrain, (void *)&command, iPipe[1]);
+		}
+	}
+
+	close(iPipe[1]);
+
+	while((iRead = read(iPipe[0], buffer, sizeof(buffer))) > 0)
+	{
+		results.append(buffer, iRead);
+	}
+
+	close(iPipe[0]);
+
+	fputs(results.c_str(), stdout);
+
+	if(szOutput)
+	{
+		FILE *pFile = fopen(szOutput, "a");
+
+		if(pFile == NULL)
+		{
+			perror(szOutput);
+			return(2);
+		}
+
+		fputs(results.c_str(), pFile);
+		fclose(pFile);
+	}
+
+	if(szBaseline && !Compare(baseline, results, fLimit))
+	{
+		return(1);
+	}
+
+	return(bFinished ? 0 : 2);
+}
@@ -0,0 +1,582 @@
+/** \file
+ * Latency and throughput comparison of the old named pipe transport and the
+ * in-process MessageQueue.
+ *
+ * Two loads are generated against a single receiving "component":
+ *  - a teleop sender that behaves like RhsRobot::Run, one cheezy drive message
+ *    every 20ms over a pipe handle that stays open
+ *  - an autonomous sender that fires bursts of commands, opening and closing
+ *    the pipe for every message like Autonomous::CommandNoResponse used to
+ *
+ * The receiver runs the same select()/read() loop ComponentBase used, or the
+ * MessageQueue receive, and records how long each message waited.  A last
+ * test queues a stop behind a backlog and reports where it came out, one
+ * builds the backlog a blocking handler leaves behind and counts how many
+ * loops and handler calls it takes to work through it one message at a time
+ * and with ReceiveBatch(), one stalls the receiver for 50ms while a sender
+ * overfills the mailbox under each overflow policy, and
+ * another publishes state changes on the MessageBus to a component sized set
+ * of mailboxes and times the fan-out and the delivery to the last subscriber.
+ *
+ * This does not need WPILib and runs on any Linux box:
+ * \verbatim
+   g++ -std=c++11 -O2 -I. bench/MessageQueueBench.cpp MessageQueue.cpp MessageBus.cpp RobotClock.cpp -o mqbench -lpthread
+   ./mqbench [seconds]
+   \endverbatim
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <sys/select.h>
+#include <sys/stat.h>
+#include <mutex>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include <MessageQueue.h>
+#include <MessageBus.h>
+#include <RobotMessage.h>
+
+const char* const BENCH_QUEUE = "/tmp/qBench";
+
+const unsigned uTeleopPeriodUs = 20000;		// 50Hz driver station packets
+const unsigned uBurstPeriodUs = 100000;		// autonomous fires a burst every 100ms
+const unsigned uBurstLength = 10;
+const unsigned uThroughputMessages = 200000;
+const unsigned uMaxSamples = 1 << 20;
+const unsigned uFanoutSubscribers = 6;		// one per component
+const unsigned uFanoutPublishes = 1000;
+
+static long long NowUs()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return((long long)now.tv_sec * 1000000LL + now.tv_nsec / 1000);
+}
+
+/// the two ways of getting a message from one task to another
+class Transport
+{
+public:
+	virtual ~Transport() {};
+	virtual void SendCached(RobotMessage *pMessage) = 0;	// handle opened once
+	virtual void SendOneShot(RobotMessage *pMessage) = 0;	// handle opened per message
+	virtual bool Receive(RobotMessage *pMessage) = 0;
+	virtual const char *GetName() = 0;
+
+	void Drain()
+	{
+		RobotMessage message;
+
+		while(Receive(&message))
+		{
+			// intentionally empty
+		}
+	}
+};
+
+class PipeTransport : public Transport
+{
+public:
+	PipeTransport()
+	{
+		unlink(BENCH_QUEUE);
+		mkfifo(BENCH_QUEUE, 0666);
+
+		// opening the read side of a fifo blocks until there is a writer
+
+		iPipeRcv = open(BENCH_QUEUE, O_RDWR);
+		iPipeXmt = open(BENCH_QUEUE, O_WRONLY);
+	}
+
+	~PipeTransport()
+	{
+		close(iPipeXmt);
+		close(iPipeRcv);
+		unlink(BENCH_QUEUE);
+	}
+
+	void SendCached(RobotMessage *pMessage)
+	{
+		write(iPipeXmt, (char*)pMessage, sizeof(RobotMessage));
+	}
+
+	void SendOneShot(RobotMessage *pMessage)
+	{
+		int iPipe = open(BENCH_QUEUE, O_WRONLY);
+
+		write(iPipe, (char*)pMessage, sizeof(RobotMessage));
+		close(iPipe);
+	}
+
+	bool Receive(RobotMessage *pMessage)
+	{
+		fd_set selectSet;
+		struct timeval timeout;
+
+		FD_ZERO(&selectSet);
+		FD_SET(iPipeRcv, &selectSet);
+
+		timeout.tv_sec = 0;
+		timeout.tv_usec = 40000;
+
+		if(select(iPipeRcv + 1, &selectSet, NULL, NULL, &timeout) == 0)
+		{
+			return(false);
+		}
+
+		return(read(iPipeRcv, (char*)pMessage, sizeof(RobotMessage)) == sizeof(RobotMessage));
+	}
+
+	const char *GetName() { return("pipe"); };
+
+private:
+	int iPipeRcv;
+	int iPipeXmt;
+};
+
+class MailboxTransport : public Transport
+{
+public:
+	MailboxTransport() : queue(BENCH_QUEUE) {};
+
+	void SendCached(RobotMessage *pMessage)
+	{
+		queue.Send(pMessage);
+	}
+
+	void SendOneShot(RobotMessage *pMessage)
+	{
+		MessageQueue::GetEndpoint(BENCH_QUEUE)->Send(pMessage);
+	}
+
+	bool Receive(RobotMessage *pMessage)
+	{
+		return(queue.Receive(pMessage, 40000));
+	}
+
+	const char *GetName() { return("mailbox"); };
+
+private:
+	MessageQueue queue;
+};
+
+static void Report(const char *szTransport, const char *szTest, std::vector<long long> &samples)
+{
+	long long llTotal = 0;
+
+	if(samples.empty())
+	{
+		printf("%-8s %-10s no samples\n", szTransport, szTest);
+		return;
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	for(unsigned i = 0; i < samples.size(); ++i)
+	{
+		llTotal += samples[i];
+	}
+
+	printf("%-8s %-10s n=%-7u mean=%6.1lfus p50=%5lldus p99=%5lldus max=%6lldus\n",
+			szTransport, szTest, (unsigned)samples.size(),
+			(double)llTotal / samples.size(),
+			samples[samples.size() / 2],
+			samples[(samples.size() * 99) / 100],
+			samples.back());
+}
+
+static void LatencyUnderLoad(Transport *pTransport, int iSeconds)
+{
+	std::vector<long long> sendTimes(uMaxSamples);
+	std::vector<long long> teleop;
+	std::vector<long long> autonomous;
+	std::atomic<bool> bRunning(true);
+	std::atomic<unsigned> uNextId(0);
+	RobotMessage message;
+	unsigned uExpected;
+
+	// the driver station loop
+
+	std::thread teleopTask([&]() {
+		RobotMessage robotMessage;
+		long long llNext = NowUs();
+
+		robotMessage.command = COMMAND_DRIVETRAIN_DRIVE_CHEEZY;
+
+		while(bRunning)
+		{
+			unsigned uId = uNextId++ % uMaxSamples;
+
+			GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(robotMessage).wheel = uId;
+			sendTimes[uId] = NowUs();
+			pTransport->SendCached(&robotMessage);
+
+			llNext += uTeleopPeriodUs;
+			usleep((unsigned)std::max(0LL, llNext - NowUs()));
+		}
+	});
+
+	// the autonomous script thread
+
+	std::thread autoTask([&]() {
+		RobotMessage robotMessage;
+
+		robotMessage.command = COMMAND_DRIVETRAIN_AUTO_MOVE;
+
+		while(bRunning)
+		{
+			for(unsigned i = 0; i < uBurstLength; ++i)
+			{
+				unsigned uId = uNextId++ % uMaxSamples;
+
+				GetParams<COMMAND_DRIVETRAIN_AUTO_MOVE>(robotMessage).left = uId;
+				sendTimes[uId] = NowUs();
+				pTransport->SendOneShot(&robotMessage);
+			}
+
+			usleep(uBurstPeriodUs);
+		}
+	});
+
+	long long llStop = NowUs() + iSeconds * 1000000LL;
+
+	while(NowUs() < llStop)
+	{
+		if(pTransport->Receive(&message))
+		{
+			// message ids fit exactly in a float, the samples stay well under 2^24
+
+			if(message.command == COMMAND_DRIVETRAIN_DRIVE_CHEEZY)
+			{
+				unsigned uId = (unsigned)GetParams<COMMAND_DRIVETRAIN_DRIVE_CHEEZY>(message).wheel;
+
+				teleop.push_back(NowUs() - sendTimes[uId]);
+			}
+			else
+			{
+				unsigned uId = (unsigned)GetParams<COMMAND_DRIVETRAIN_AUTO_MOVE>(message).left;
+
+				autonomous.push_back(NowUs() - sendTimes[uId]);
+			}
+		}
+	}
+
+	bRunning = false;
+	teleopTask.join();
+	autoTask.join();
+
+	// drain whatever is left so the senders are not stuck on a full queue
+
+	uExpected = uNextId - teleop.size() - autonomous.size();
+
+	while(uExpected-- && pTransport->Receive(&message))
+	{
+		// intentionally empty
+	}
+
+	Report(pTransport->GetName(), "teleop", teleop);
+	Report(pTransport->GetName(), "autoburst", autonomous);
+}
+
+static void Throughput(Transport *pTransport)
+{
+	RobotMessage message;
+	long long llStart = NowUs();
+
+	std::thread sender([&]() {
+		RobotMessage robotMessage;
+
+		// continuous drive commands are coalesced, use one that is queued
+
+		robotMessage.command = COMMAND_DRIVETRAIN_AUTO_MOVE;
+
+		for(unsigned i = 0; i < uThroughputMessages; ++i)
+		{
+			pTransport->SendCached(&robotMessage);
+		}
+	});
+
+	for(unsigned i = 0; i < uThroughputMessages; ++i)
+	{
+		while(!pTransport->Receive(&message))
+		{
+			// intentionally empty
+		}
+	}
+
+	sender.join();
+
+	long long llElapsed = NowUs() - llStart;
+
+	printf("%-8s %-10s %u messages in %lldus, %.0lf msgs/s, %.2lfus/msg\n",
+			pTransport->GetName(), "throughput", uThroughputMessages, llElapsed,
+			uThroughputMessages * 1e6 / llElapsed, (double)llElapsed / uThroughputMessages);
+}
+
+static void StopBehindBacklog(Transport *pTransport)
+{
+	RobotMessage message;
+	unsigned uPosition = 0;
+
+	// a backlog of bulk traffic with a stop at the very end
+
+	message.command = COMMAND_DRIVETRAIN_AUTO_MOVE;
+
+	for(unsigned i = 0; i < uBurstLength * 6; ++i)
+	{
+		pTransport->SendCached(&message);
+	}
+
+	message.command = COMMAND_DRIVETRAIN_STOP;
+	pTransport->SendCached(&message);
+
+	// which message out of the mailbox was the stop?
+
+	while(pTransport->Receive(&message))
+	{
+		uPosition++;
+
+		if(message.command == COMMAND_DRIVETRAIN_STOP)
+		{
+			break;
+		}
+	}
+
+	pTransport->Drain();
+
+	printf("%-8s %-10s stop delivered %u of %u\n",
+			pTransport->GetName(), "priority", uPosition, uBurstLength * 6 + 1);
+}
+
+static void BacklogCatchUp()
+{
+	MessageQueue queue("/tmp/qBacklog");
+	RobotMessage batch[MESSAGE_BATCH_SIZE];
+	RobotMessage message;
+	unsigned uSent = 0;
+	unsigned uLoops;
+	unsigned uHandled;
+	unsigned uCount;
+	bool bFull;
+	long long llStart;
+
+	// half a second stuck in a handler: 25 packets of autonomous moves with
+	// an arm command every fifth one
+
+	for(int iPass = 0; iPass < 2; ++iPass)
+	{
+		uSent = 0;
+
+		for(unsigned i = 0; i < 25; ++i)
+		{
+			message.command = COMMAND_DRIVETRAIN_AUTO_MOVE;
+			GetParams<COMMAND_DRIVETRAIN_AUTO_MOVE>(message).left = i;
+			queue.Send(&message);
+			uSent++;
+
+			if((i % 5) == 4)
+			{
+				message.command = COMMAND_ARM_INTAKE;
+				queue.Send(&message);
+				uSent++;
+			}
+		}
+
+		uLoops = 0;
+		uHandled = 0;
+		llStart = NowUs();
+
+		if(iPass == 0)
+		{
+			// the old loop, one message each time around
+
+			while(queue.TryReceive(&message))
+			{
+				uLoops++;
+				uHandled++;
+			}
+		}
+		else
+		{
+			do
+			{
+				uCount = queue.ReceiveBatch(batch, MESSAGE_BATCH_SIZE, 0, &bFull);
+				uHandled += uCount;
+				uLoops += (uCount > 0);
+			} while(bFull);
+
+			// the newest move must be the one that survives
+
+			for(unsigned i = 0; i < uHandled; ++i)
+			{
+				if((batch[i].command == COMMAND_DRIVETRAIN_AUTO_MOVE) &&
+						(GetParams<COMMAND_DRIVETRAIN_AUTO_MOVE>(batch[i]).left != 24))
+				{
+					printf("batch kept a stale move!\n");
+				}
+			}
+		}
+
+		printf("%-8s %-10s %u queued, %u loops, %u handled, %lld us\n",
+				"mailbox", iPass ? "batch" : "one each", uSent, uLoops, uHandled, NowUs() - llStart);
+	}
+}
+
+static void OverflowPolicies()
+{
+	static const char * const szPolicies[MESSAGE_OVERFLOW_LAST] = { "block", "drop old", "drop new", "overwrite" };
+	const unsigned uSends = MESSAGE_QUEUE_DEPTH * 4;
+
+	for(int iPolicy = 0; iPolicy < MESSAGE_OVERFLOW_LAST; ++iPolicy)
+	{
+		MessageQueue queue("/tmp/qOverflow");
+		MessageLaneStats stats;
+		RobotMessage message;
+		long long llSendMaxUs = 0;
+		long long llStart;
+		unsigned uReceived = 0;
+		float fFirst = -1.0;
+		float fLast = -1.0;
+
+		queue.SetOverflow(MESSAGE_LANE_NORMAL, iPolicy);
+
+		// a receiver stuck in a long handler, then catching up
+
+		std::thread receiver([&]() {
+			RobotMessage robotMessage;
+
+			usleep(50000);
+
+			while(queue.Receive(&robotMessage, 20000))
+			{
+				fLast = GetParams<COMMAND_DRIVETRAIN_AUTO_MOVE>(robotMessage).left;
+				fFirst = (uReceived++ == 0) ? fLast : fFirst;
+			}
+		});
+
+		message.command = COMMAND_DRIVETRAIN_AUTO_MOVE;
+
+		for(unsigned i = 0; i < uSends; ++i)
+		{
+			GetParams<COMMAND_DRIVETRAIN_AUTO_MOVE>(message).left = i;
+			llStart = NowUs();
+			queue.Send(&message);
+			llSendMaxUs = std::max(llSendMaxUs, NowUs() - llStart);
+		}
+
+		receiver.join();
+		queue.GetLaneStats(MESSAGE_LANE_NORMAL, stats);
+
+		printf("%-8s %-10s %u sent, longest send %6lldus, %4u full, %4u dropped, %4u received, ids %.0f..%.0f\n",
+				"mailbox", szPolicies[iPolicy], uSends, llSendMaxUs, stats.uOverflows, stats.uDropped,
+				uReceived, fFirst, fLast);
+	}
+}
+
+static void Fanout()
+{
+	std::vector<MessageQueue *> queues;
+	std::vector<long long> publish;
+	std::vector<long long> delivery;
+	std::atomic<long long> llSent(0);
+	std::atomic<unsigned> uReceived(0);
+	std::vector<std::thread> receivers;
+	std::mutex mutexDelivery;
+	RobotMessage message;
+	char szName[32];
+
+	for(unsigned i = 0; i < uFanoutSubscribers; ++i)
+	{
+		snprintf(szName, sizeof(szName), "/tmp/qFanout%u", i);
+		queues.push_back(new MessageQueue(strdup(szName)));
+		MessageBus::Subscribe(MESSAGE_TOPIC_ROBOT_STATE, queues[i]);
+	}
+
+	// every subscriber runs its own task like a component would
+
+	for(unsigned i = 0; i < uFanoutSubscribers; ++i)
+	{
+		receivers.push_back(std::thread([&, i]() {
+			RobotMessage robotMessage;
+
+			for(unsigned j = 0; j < uFanoutPublishes; ++j)
+			{
+				while(!queues[i]->Receive(&robotMessage, 40000))
+				{
+					// intentionally empty
+				}
+
+				if(++uReceived % uFanoutSubscribers == 0)
+				{
+					std::lock_guard<std::mutex> sync(mutexDelivery);
+					delivery.push_back(NowUs() - llSent);
+				}
+			}
+		}));
+	}
+
+	message.command = COMMAND_ROBOT_STATE_TELEOPERATED;
+
+	for(unsigned i = 0; i < uFanoutPublishes; ++i)
+	{
+		// wait for the last publish to land everywhere first
+
+		while(uReceived < i * uFanoutSubscribers)
+		{
+			sched_yield();
+		}
+
+		llSent = NowUs();
+		MessageBus::Publish(MESSAGE_TOPIC_ROBOT_STATE, &message);
+		publish.push_back(NowUs() - llSent);
+	}
+
+	for(unsigned i = 0; i < uFanoutSubscribers; ++i)
+	{
+		receivers[i].join();
+		MessageBus::Unsubscribe(MESSAGE_TOPIC_ROBOT_STATE, queues[i]);
+		delete queues[i];
+	}
+
+	Report("bus", "publish", publish);
+	Report("bus", "delivered", delivery);
+}
+
+int main(int argc, char **argv)
+{
+	int iSeconds = (argc > 1) ? atoi(argv[1]) : 5;
+
+	printf("message transport benchmark, %d seconds of load per transport\n", iSeconds);
+
+	{
+		PipeTransport pipeTransport;
+
+		Throughput(&pipeTransport);
+		StopBehindBacklog(&pipeTransport);
+		LatencyUnderLoad(&pipeTransport, iSeconds);
+	}
+
+	{
+		MailboxTransport mailboxTransport;
+
+		Throughput(&mailboxTransport);
+		StopBehindBacklog(&mailboxTransport);
+		LatencyUnderLoad(&mailboxTransport, iSeconds);
+	}
+
+	BacklogCatchUp();
+	OverflowPolicies();
+
+	Fanout();
+
+	return(0);
+}
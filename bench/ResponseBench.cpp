@@ -0,0 +1,181 @@
+/** \file
+ * CPU cost of waiting for autonomous command responses, spinning on a flag
+ * against sleeping on a PendingResponses future.
+ *
+ * Three threads stand in for the robot's:
+ *  - a script thread, like tAutoEx, that sends a command and waits for its
+ *    response, over and over
+ *  - a responder, like Drivetrain, that takes BENCH_COMMAND_MS to finish each
+ *    command and then replies through its mailbox
+ *  - a receiver, like tAuto, that takes the replies out of its mailbox and
+ *    either sets the flag or completes the future
+ *
+ * Reported are the CPU time the script thread used as a share of wall time and
+ * how long it took the script to notice each response.  Pass "1" as the second
+ * argument to squeeze every thread onto one CPU, where the spinning script also
+ * starves the receiver it is waiting on.
+ *
+ * This does not need WPILib and runs on any Linux box:
+ * \verbatim
+   g++ -std=c++11 -O2 -I. bench/ResponseBench.cpp MessageQueue.cpp PendingResponses.cpp RobotClock.cpp -o responsebench -lpthread
+   ./responsebench [seconds] [one cpu]
+   \endverbatim
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+//Robot
+#include <MessageQueue.h>
+#include <PendingResponses.h>
+
+const unsigned BENCH_COMMAND_MS = 50;
+
+static std::atomic<bool> bRunning;
+static std::atomic<bool> bReceivedCommandResponse;	// the old way, it was not even atomic
+static PendingResponses responses;
+
+static long long NowUs()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return((long long)now.tv_sec * 1000000LL + now.tv_nsec / 1000);
+}
+
+static long long ThreadCpuUs()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+	return((long long)now.tv_sec * 1000000LL + now.tv_nsec / 1000);
+}
+
+static void Responder(MessageQueue *pQueue, MessageQueue *pReplyQueue)
+{
+	RobotMessage message;
+	RobotMessage reply;
+
+	while(bRunning.load())
+	{
+		if(pQueue->Receive(&message, 100000))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(BENCH_COMMAND_MS));
+
+			reply.command = COMMAND_AUTONOMOUS_RESPONSE_OK;
+			reply.replyQ = NULL;
+			reply.uCorrelation = message.uCorrelation;
+			pReplyQueue->Send(&reply);
+		}
+	}
+}
+
+static void Receiver(MessageQueue *pQueue, bool bFutures)
+{
+	RobotMessage message;
+
+	while(bRunning.load())
+	{
+		if(pQueue->Receive(&message, 100000))
+		{
+			if(bFutures)
+			{
+				responses.Complete(&message);
+			}
+			else
+			{
+				bReceivedCommandResponse.store(true);
+			}
+		}
+	}
+}
+
+static void Script(MessageQueue *pQueue, bool bFutures, int iSeconds,
+		float *pCpuPercent, std::vector<long long> *pLatency)
+{
+	RobotMessage message;
+	std::future<MessageCommand> response;
+	long long llStart = NowUs();
+	long long llCpuStart = ThreadCpuUs();
+	long long llEnd = llStart + iSeconds * 1000000LL;
+	long long llSent;
+
+	message.command = COMMAND_DRIVETRAIN_STRAIGHT;
+	message.replyQ = "/tmp/qAuto";
+
+	while(NowUs() < llEnd)
+	{
+		llSent = NowUs();
+
+		if(bFutures)
+		{
+			response = responses.Expect(&message);
+			pQueue->Send(&message);
+			response.wait_for(std::chrono::seconds(1));
+		}
+		else
+		{
+			message.uCorrelation = CORRELATION_NONE;
+			bReceivedCommandResponse.store(false);
+			pQueue->Send(&message);
+
+			while(!bReceivedCommandResponse.load())
+			{
+				//purposefully empty
+			}
+		}
+
+		pLatency->push_back(NowUs() - llSent - BENCH_COMMAND_MS * 1000);
+	}
+
+	*pCpuPercent = 100.0 * (ThreadCpuUs() - llCpuStart) / (NowUs() - llStart);
+}
+
+static void Run(bool bFutures, int iSeconds)
+{
+	MessageQueue commandQueue("/tmp/qDrive");
+	MessageQueue replyQueue("/tmp/qAuto");
+	std::vector<long long> latency;
+	float fCpuPercent = 0.0;
+
+	bRunning.store(true);
+
+	std::thread responder(Responder, &commandQueue, &replyQueue);
+	std::thread receiver(Receiver, &replyQueue, bFutures);
+	std::thread script(Script, &commandQueue, bFutures, iSeconds, &fCpuPercent, &latency);
+
+	script.join();
+	bRunning.store(false);
+	responder.join();
+	receiver.join();
+
+	std::sort(latency.begin(), latency.end());
+
+	printf("%-7s script cpu %6.2f%%  commands %4u  notice p50 %6lldus p99 %6lldus max %6lldus\n",
+			bFutures ? "future" : "spin", fCpuPercent, (unsigned)latency.size(),
+			latency[latency.size() / 2], latency[latency.size() * 99 / 100], latency.back());
+}
+
+int main(int argc, char **argv)
+{
+	int iSeconds = (argc > 1) ? atoi(argv[1]) : 5;
+	cpu_set_t cpus;
+
+	if((argc > 2) && atoi(argv[2]))
+	{
+		CPU_ZERO(&cpus);
+		CPU_SET(0, &cpus);
+		sched_setaffinity(0, sizeof(cpus), &cpus);
+	}
+
+	Run(false, iSeconds);
+	Run(true, iSeconds);
+	return(0);
+}
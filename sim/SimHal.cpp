@@ -0,0 +1,685 @@
+/** \file
+ * Host stand-in for the parts of WPILib this robot uses.
+ *
+ * Every device here is a thin handle on a SimWorld model; see SimWorld.h for
+ * what each model does.  Configuration calls that only tune the real hardware
+ * (clock rates, PID gains inside a talon, ramp rates) are accepted and ignored.
+ * Wait() and Timer run on the RobotClock, so they keep pace with everything
+ * else when the simulator runs faster than real time.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+//Robot
+#include <WPILib.h>
+#include <SimWorld.h>
+#include <RobotClock.h>
+
+void Wait(double fSeconds)
+{
+	if(fSeconds > 0.0)
+	{
+		RobotClock::Sleep(fSeconds);
+	}
+	else
+	{
+		std::this_thread::yield();
+	}
+}
+
+Task::~Task()
+{
+	// like the roboRIO, deleting the task does not stop the thread
+
+	if(thread.joinable())
+	{
+		thread.detach();
+	}
+}
+
+Timer::Timer()
+{
+	fStartTime = RobotClock::Now();
+	fAccumulated = 0.0;
+	bRunning = false;
+}
+
+void Timer::Start()
+{
+	std::lock_guard<std::mutex> sync(mutexTimer);
+
+	if(!bRunning)
+	{
+		fStartTime = RobotClock::Now();
+		bRunning = true;
+	}
+}
+
+void Timer::Stop()
+{
+	std::lock_guard<std::mutex> sync(mutexTimer);
+
+	if(bRunning)
+	{
+		fAccumulated += RobotClock::Now() - fStartTime;
+		bRunning = false;
+	}
+}
+
+void Timer::Reset()
+{
+	std::lock_guard<std::mutex> sync(mutexTimer);
+
+	fAccumulated = 0.0;
+	fStartTime = RobotClock::Now();
+}
+
+double Timer::Get() const
+{
+	std::lock_guard<std::mutex> sync(mutexTimer);
+
+	if(bRunning)
+	{
+		return(fAccumulated + RobotClock::Now() - fStartTime);
+	}
+
+	return(fAccumulated);
+}
+
+double Timer::GetFPGATimestamp()
+{
+	return(RobotClock::Now());
+}
+
+CANTalon::CANTalon(int iDeviceNumber)
+{
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	pModel = SimWorld::GetTalon(iDeviceNumber);
+	pModel->bPresent = true;
+	pModel->bEnabled = true;
+	pModel->iMode = kPercentVbus;
+	pModel->fValue = 0.0;
+}
+
+CANTalon::~CANTalon()
+{
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	pModel->bPresent = false;
+}
+
+void CANTalon::Set(float fValue)
+{
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	pModel->fValue = fValue;
+}
+
+float CANTalon::Get()
+{
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	switch(pModel->iMode)
+	{
+	case kSpeed:
+		return(pModel->fSpeed);
+	case kPercentVbus:
+	case kFollower:
+		return(pModel->fOutput);
+	default:
+		return(pModel->fValue);
+	}
+}
+
+void CANTalon::SetControlMode(ControlMode mode)
+{
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	if(pModel->iMode != mode)
+	{
+		pModel->iMode = mode;
+		pModel->fValue = 0.0;
+	}
+}
+
+void CANTalon::ConfigNeutralMode(NeutralMode mode)
+{
+}
+
+void CANTalon::SetFeedbackDevice(FeedbackDevice device)
+{
+}
+
+void CANTalon::ConfigEncoderCodesPerRev(uint16_t uCodesPerRev)
+{
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	pModel->iCountsPerRev = uCodesPerRev * 4;		// quadrature counts every edge
+}
+
+void CANTalon::SelectProfileSlot(int iSlot)
+{
+}
+
+void CANTalon::SetPID(double fP, double fI, double fD, double fF)
+{
+}
+
+void CANTalon::SetIzone(unsigned uIzone)
+{
+}
+
+void CANTalon::SetCloseLoopRampRate(double fRampRate)
+{
+}
+
+void CANTalon::SetInverted(bool bInverted)
+{
+	// the inversion undoes how the motor is mounted, so in the model the
+	// encoder still moves the way the command asks
+
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	pModel->bInverted = bInverted;
+}
+
+bool CANTalon::IsAlive()
+{
+	return(true);
+}
+
+int CANTalon::GetEncPosition()
+{
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	return((int)pModel->fPosition - pModel->iPositionOffset);
+}
+
+void CANTalon::SetEncPosition(int iPosition)
+{
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	pModel->iPositionOffset = (int)pModel->fPosition - iPosition;
+}
+
+int CANTalon::GetPulseWidthPosition()
+{
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	return((int)pModel->fPosition);
+}
+
+double CANTalon::GetSpeed()
+{
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	return(pModel->fSpeed);
+}
+
+double CANTalon::GetOutputCurrent()
+{
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	return(pModel->fCurrent);
+}
+
+void CANTalon::Enable()
+{
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	pModel->bEnabled = true;
+}
+
+void CANTalon::Disable()
+{
+	std::lock_guard<std::mutex> sync(SimWorld::GetMutex());
+
+	pModel->bEnabled = false;
+}
+
+void CANTalon::PIDWrite(float fOutput)
+{
+	Set(fOutput);
+}
+
+double CANTalon::PIDGet()
+{
+	return(GetEncPosition());
+}
+
+SPI::SPI(Port port)
+{
+	this->port = port;
+}
+
+SPI::~SPI()
+{
+}
+
+void SPI::SetClockRate(double fHz) {}
+void SPI::SetMSBFirst() {}
+void SPI::SetLSBFirst() {}
+void SPI::SetSampleDataOnFalling() {}
+void SPI::SetSampleDataOnRising() {}
+void SPI::SetClockActiveLow() {}
+void SPI::SetClockActiveHigh() {}
+void SPI::SetChipSelectActiveHigh() {}
+void SPI::SetChipSelectActiveLow() {}
+
+int SPI::Write(uint8_t *pData, uint8_t uSize)
+{
+	return(uSize);
+}
+
+int SPI::Read(bool bInitiate, uint8_t *pData, uint8_t uSize)
+{
+	// nothing but the gyro is modelled, everything else answers zeros
+
+	memset(pData, 0, uSize);
+	return(uSize);
+}
+
+int SPI::Transaction(uint8_t *pDataToSend, uint8_t *pDataReceived, uint8_t uSize)
+{
+	SimWorld::GyroTransaction(port, pDataToSend, pDataReceived, uSize);
+	return(uSize);
+}
+
+void SPI::InitAccumulator(double fPeriod, uint32_t uCmd, uint8_t uXferSize, uint32_t uValidMask,
+		uint32_t uValidValue, uint8_t uDataShift, uint8_t uDataSize, bool bIsSigned, bool bBigEndian)
+{
+}
+
+void SPI::FreeAccumulator() {}
+void SPI::ResetAccumulator() {}
+void SPI::SetAccumulatorCenter(int32_t iCenter) {}
+int32_t SPI::GetAccumulatorLastValue() const { return(0); }
+int64_t SPI::GetAccumulatorValue() const { return(0); }
+uint32_t SPI::GetAccumulatorCount() const { return(0); }
+double SPI::GetAccumulatorAverage() const { return(0.0); }
+
+AnalogInput::AnalogInput(uint32_t uChannel)
+{
+	this->uChannel = uChannel;
+}
+
+float AnalogInput::GetVoltage() const
+{
+	return(SimWorld::GetAnalog(uChannel));
+}
+
+float AnalogInput::GetAverageVoltage() const
+{
+	return(SimWorld::GetAnalog(uChannel));
+}
+
+DigitalInput::DigitalInput(uint32_t uChannel)
+{
+	this->uChannel = uChannel;
+}
+
+bool DigitalInput::Get() const
+{
+	return(SimWorld::GetDigital(uChannel));
+}
+
+Relay::Relay(uint32_t uChannel, Direction direction)
+{
+	this->uChannel = uChannel;
+	SimWorld::SetRelay(uChannel, kOff);
+}
+
+void Relay::Set(Value value)
+{
+	SimWorld::SetRelay(uChannel, value);
+}
+
+Relay::Value Relay::Get() const
+{
+	return((Value)SimWorld::GetRelay(uChannel));
+}
+
+SolenoidBase::SolenoidBase(uint8_t uModuleNumber)
+{
+	this->uModuleNumber = uModuleNumber;
+}
+
+void SolenoidBase::Set(uint8_t uValue, uint8_t uMask, int iModule)
+{
+	SimWorld::SetSolenoids(iModule, uValue, uMask);
+}
+
+uint8_t SolenoidBase::GetAll(int iModule) const
+{
+	return(SimWorld::GetSolenoids(iModule));
+}
+
+Solenoid::Solenoid(uint8_t uModuleNumber, uint32_t uChannel)
+: SolenoidBase(uModuleNumber)
+{
+	this->uChannel = uChannel;
+}
+
+void Solenoid::Set(bool bOn)
+{
+	SolenoidBase::Set(bOn ? (1 << uChannel) : 0, 1 << uChannel, uModuleNumber);
+}
+
+bool Solenoid::Get() const
+{
+	return((GetAll(uModuleNumber) >> uChannel) & 1);
+}
+
+PIDController::PIDController(float fP, float fI, float fD, PIDSource *pSource, PIDOutput *pOutput, float fPeriod)
+{
+	this->fP = fP;
+	this->fI = fI;
+	this->fD = fD;
+	this->pSource = pSource;
+	this->pOutput = pOutput;
+	this->fPeriod = fPeriod;
+	fMinimumOutput = -1.0;
+	fMaximumOutput = 1.0;
+	fSetpoint = 0.0;
+	fError = 0.0;
+	fPrevError = 0.0;
+	fAvgError = 0.0;
+	fTotalError = 0.0;
+	bEnabled = false;
+	bStop = false;
+	thread = std::thread(&PIDController::Run, this);
+	SimWorld::NameThread(thread.native_handle(), "tPIDController");
+}
+
+PIDController::~PIDController()
+{
+	bStop = true;
+	thread.join();
+}
+
+void PIDController::Run(PIDController *pThis)
+{
+	while(!pThis->bStop)
+	{
+		Wait(pThis->fPeriod);
+		pThis->Calculate();
+	}
+}
+
+void PIDController::Calculate()
+{
+	std::lock_guard<std::recursive_mutex> sync(mutexPID);
+	float fResult;
+
+	if(!bEnabled)
+	{
+		return;
+	}
+
+	fError = fSetpoint - pSource->PIDGet();
+
+	if(fI != 0.0)
+	{
+		float fPotentialI = (fTotalError + fError) * fI;
+
+		if((fPotentialI < fMaximumOutput) && (fPotentialI > fMinimumOutput))
+		{
+			fTotalError += fError;
+		}
+	}
+
+	fResult = fP * fError + fI * fTotalError + fD * (fError - fPrevError);
+	fResult = fmax(fMinimumOutput, fmin(fMaximumOutput, fResult));
+	fPrevError = fError;
+	fAvgError += (fError - fAvgError) * 0.2;
+
+	pOutput->PIDWrite(fResult);
+}
+
+void PIDController::SetSetpoint(float fSetpoint)
+{
+	std::lock_guard<std::recursive_mutex> sync(mutexPID);
+
+	this->fSetpoint = fSetpoint;
+}
+
+double PIDController::GetSetpoint() const
+{
+	std::lock_guard<std::recursive_mutex> sync(mutexPID);
+
+	return(fSetpoint);
+}
+
+void PIDController::SetOutputRange(float fMinimum, float fMaximum)
+{
+	std::lock_guard<std::recursive_mutex> sync(mutexPID);
+
+	fMinimumOutput = fMinimum;
+	fMaximumOutput = fMaximum;
+}
+
+void PIDController::SetTolerance(float fPercent)
+{
+}
+
+float PIDController::GetError() const
+{
+	std::lock_guard<std::recursive_mutex> sync(mutexPID);
+
+	return(fError);
+}
+
+float PIDController::GetAvgError() const
+{
+	std::lock_guard<std::recursive_mutex> sync(mutexPID);
+
+	return(fAvgError);
+}
+
+void PIDController::Enable()
+{
+	std::lock_guard<std::recursive_mutex> sync(mutexPID);
+
+	bEnabled = true;
+}
+
+void PIDController::Disable()
+{
+	std::lock_guard<std::recursive_mutex> sync(mutexPID);
+
+	if(bEnabled)
+	{
+		pOutput->PIDWrite(0.0);
+	}
+
+	bEnabled = false;
+}
+
+bool PIDController::IsEnabled() const
+{
+	std::lock_guard<std::recursive_mutex> sync(mutexPID);
+
+	return(bEnabled);
+}
+
+Joystick::Joystick(uint32_t uPort)
+{
+	this->uPort = uPort;
+}
+
+float Joystick::GetRawAxis(uint32_t uAxis) const
+{
+	return(SimWorld::GetJoystickAxis(uPort, uAxis));
+}
+
+bool Joystick::GetRawButton(uint32_t uButton) const
+{
+	return(SimWorld::GetJoystickButton(uPort, uButton));
+}
+
+int Joystick::GetPOV(uint32_t uPov) const
+{
+	return((uPov == 0) ? SimWorld::GetJoystickPOV(uPort) : -1);
+}
+
+DriverStation &DriverStation::GetInstance()
+{
+	static DriverStation instance;
+
+	return(instance);
+}
+
+void DriverStation::ReportError(std::string error)
+{
+	fprintf(stderr, "%s\n", error.c_str());
+}
+
+void DriverStation::WaitForData()
+{
+	SimWorld::WaitForPacket();
+}
+
+float DriverStation::GetBatteryVoltage() const
+{
+	return(SimWorld::GetBatteryVoltage());
+}
+
+double DriverStation::GetMatchTime() const
+{
+	return(SimWorld::GetMatchTime());
+}
+
+bool DriverStation::IsDisabled() const
+{
+	return(!SimWorld::IsEnabled());
+}
+
+bool DriverStation::IsEnabled() const
+{
+	return(SimWorld::IsEnabled());
+}
+
+bool DriverStation::IsAutonomous() const
+{
+	return(SimWorld::GetMode() == SIM_MODE_AUTONOMOUS);
+}
+
+bool DriverStation::IsOperatorControl() const
+{
+	return(SimWorld::GetMode() == SIM_MODE_TELEOP);
+}
+
+bool DriverStation::IsTest() const
+{
+	return(SimWorld::GetMode() == SIM_MODE_TEST);
+}
+
+void SmartDashboard::init()
+{
+}
+
+void SmartDashboard::PutNumber(const std::string &key, double fValue)
+{
+	char szValue[32];
+
+	snprintf(szValue, sizeof(szValue), "%g", fValue);
+	SimWorld::PutValue(key, szValue);
+}
+
+void SmartDashboard::PutString(const std::string &key, const std::string &value)
+{
+	SimWorld::PutValue(key, value);
+}
+
+void SmartDashboard::PutBoolean(const std::string &key, bool bValue)
+{
+	SimWorld::PutValue(key, bValue ? "true" : "false");
+}
+
+double SmartDashboard::GetNumber(const std::string &key, double fDefault)
+{
+	std::string value;
+
+	return(SimWorld::GetValue(key, value) ? atof(value.c_str()) : fDefault);
+}
+
+std::string SmartDashboard::GetString(const std::string &key, const std::string &defaultValue)
+{
+	std::string value;
+
+	return(SimWorld::GetValue(key, value) ? value : defaultValue);
+}
+
+bool SmartDashboard::GetBoolean(const std::string &key, bool bDefault)
+{
+	std::string value;
+
+	return(SimWorld::GetValue(key, value) ? (value == "true") : bDefault);
+}
+
+std::shared_ptr<NetworkTable> NetworkTable::GetTable(const std::string &key)
+{
+	std::shared_ptr<NetworkTable> table = std::make_shared<NetworkTable>();
+
+	table->path = "/" + key;
+	return(table);
+}
+
+std::shared_ptr<NetworkTable> NetworkTable::GetSubTable(const std::string &key)
+{
+	std::shared_ptr<NetworkTable> table = std::make_shared<NetworkTable>();
+
+	table->path = path + "/" + key;
+	return(table);
+}
+
+void NetworkTable::PutBoolean(const std::string &key, bool bValue)
+{
+	SimWorld::PutValue(path + "/" + key, bValue ? "true" : "false");
+}
+
+LiveWindow *LiveWindow::GetInstance()
+{
+	static LiveWindow instance;
+
+	return(&instance);
+}
+
+void LiveWindow::SetEnabled(bool bEnabled)
+{
+	this->bEnabled = bEnabled;
+}
+
+RobotBase *RobotBase::pInstance = NULL;
+
+RobotBase::RobotBase()
+: m_ds(DriverStation::GetInstance())
+{
+	pInstance = this;
+}
+
+RobotBase::~RobotBase()
+{
+}
+
+RobotBase &RobotBase::getInstance()
+{
+	return(*pInstance);
+}
+
+bool RobotBase::IsEnabled() const { return(m_ds.IsEnabled()); }
+bool RobotBase::IsDisabled() const { return(m_ds.IsDisabled()); }
+bool RobotBase::IsAutonomous() const { return(m_ds.IsAutonomous()); }
+bool RobotBase::IsOperatorControl() const { return(m_ds.IsOperatorControl()); }
+bool RobotBase::IsTest() const { return(m_ds.IsTest()); }
+
+void HALReport(uint8_t uResource, uint8_t uInstanceNumber, uint8_t uContext, const char *szFeature)
+{
+}
+
+void HALNetworkCommunicationObserveUserProgramStarting()
+{
+}
@@ -0,0 +1,633 @@
+/** \file
+ * In-memory models of the robot's hardware and the match it plays.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <math.h>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+//Robot
+#include <WPILib.h>
+#include <SimWorld.h>
+#include <PeriodicTimer.h>
+#include <RobotClock.h>
+#include <RobotParams.h>
+#include <ADXRS453Z.h>			//For how long the gyro calibrates
+#include <Drivetrain.h>			//For the drive talons' free speed and encoder
+
+// how this robot is put together, in the model's terms
+
+struct SimWiring
+{
+	int iCanId;
+	float fFreeSpeed;			// RPM
+	int iCountsPerRev;
+	float fStallCurrent;		// amps
+	float fTimeConstant;		// seconds
+};
+
+static const SimWiring SIM_WIRING[] =
+{
+	{ CAN_DRIVETRAIN_LEFTONE_MOTOR,		FULLSPEED_FROMTALONS,	(int)TALON_COUNTSPERREV * 4,	40.0,	0.10 },
+	{ CAN_DRIVETRAIN_LEFTTWO_MOTOR,		FULLSPEED_FROMTALONS,	(int)TALON_COUNTSPERREV * 4,	40.0,	0.10 },
+	{ CAN_DRIVETRAIN_RIGHTONE_MOTOR,	FULLSPEED_FROMTALONS,	(int)TALON_COUNTSPERREV * 4,	40.0,	0.10 },
+	{ CAN_DRIVETRAIN_RIGHTTWO_MOTOR,	FULLSPEED_FROMTALONS,	(int)TALON_COUNTSPERREV * 4,	40.0,	0.10 },
+	{ CAN_ARM_LEVER_MOTOR,				30.0,					4096,							20.0,	0.05 },
+	{ CAN_ARM_INTAKE_MOTOR,				5000.0,					4096,							10.0,	0.05 },
+	{ CAN_HANGER_MOTOR,					100.0,					4096,							30.0,	0.10 },
+	{ CAN_TAIL_MOTOR,					60.0,					4096,							10.0,	0.05 },
+};
+
+static const int SIM_DRIVE_LEFT = CAN_DRIVETRAIN_LEFTONE_MOTOR;		// forward is a falling encoder
+static const int SIM_DRIVE_RIGHT = CAN_DRIVETRAIN_RIGHTONE_MOTOR;	// forward is a rising encoder
+static const float SIM_TRACK_WIDTH = 2.0;							// feet between the wheels
+static const float SIM_PIXY_CENTERED = 1.65;						// volts, target dead ahead
+static const SPI::Port SIM_GYRO_PORT = SPI::kOnboardCS3;
+
+struct SimPhase
+{
+	SimMode mode;
+	double fDuration;
+};
+
+static std::mutex mutexWorld;
+static SimTalon talons[SIM_MAX_TALONS];
+static float fAnalog[SIM_MAX_ANALOG];
+static bool bDigital[SIM_MAX_DIGITAL];
+static int iRelay[SIM_MAX_RELAYS];
+static uint8_t uSolenoids[SIM_MAX_PCMS + 1];
+static float fAxes[SIM_MAX_JOYSTICKS][SIM_MAX_AXES];
+static bool bButtons[SIM_MAX_JOYSTICKS][SIM_MAX_BUTTONS];
+static int iPOV[SIM_MAX_JOYSTICKS];
+static double fHeading;
+static double fHeadingRate;			// degrees per second, clockwise positive
+static double fBattery = SIM_BATTERY_VOLTAGE;
+static std::map<std::string, std::string> dashboard;
+
+static std::vector<SimPhase> timeline;
+static std::atomic<int> iMode(SIM_MODE_DISABLED);
+static std::atomic<double> fPhaseLeft(0.0);
+static double fMatchStart = -1.0;
+static PeriodicTimer packetTimer(SIM_PACKET_PERIOD);
+static bool bDumpDashboard = false;
+
+static std::chrono::steady_clock::time_point realStart;
+
+static void Usage(const char *szName)
+{
+	printf("usage: %s [-p seconds] [-a seconds] [-g seconds] [-t seconds] [-T seconds] [-x rate] [-D]\n"
+			"  -p  disabled before the match, default lets the gyro calibrate\n"
+			"  -a  autonomous, default 15\n"
+			"  -g  disabled between modes, default 1\n"
+			"  -t  teleop, default 135\n"
+			"  -T  test mode after teleop, default 0 (skipped)\n"
+			"  -x  robot seconds per real second, default 1\n"
+			"  -D  print the dashboard when the match is over\n", szName);
+}
+
+int SimWorld::Main(int argc, char **argv, RobotBase *(*pCreateRobot)())
+{
+	double fPreMatch = CALIBRATE_PERIOD + 1.0;
+	double fAuto = 15.0;
+	double fGap = 1.0;
+	double fTeleop = 135.0;
+	double fTest = 0.0;
+	float fRate = 1.0;
+	int iOption;
+
+	while((iOption = getopt(argc, argv, "p:a:g:t:T:x:Dh")) != -1)
+	{
+		switch(iOption)
+		{
+		case 'p': fPreMatch = atof(optarg); break;
+		case 'a': fAuto = atof(optarg); break;
+		case 'g': fGap = atof(optarg); break;
+		case 't': fTeleop = atof(optarg); break;
+		case 'T': fTest = atof(optarg); break;
+		case 'x': fRate = atof(optarg); break;
+		case 'D': bDumpDashboard = true; break;
+		default:
+			Usage(argv[0]);
+			return(1);
+		}
+	}
+
+	if(fRate <= 0.0)
+	{
+		Usage(argv[0]);
+		return(1);
+	}
+
+	// before any task starts, see RobotClock.h
+
+	RobotClock::SetRate(fRate);
+
+	timeline.push_back({ SIM_MODE_DISABLED, fPreMatch });
+	timeline.push_back({ SIM_MODE_AUTONOMOUS, fAuto });
+	timeline.push_back({ SIM_MODE_DISABLED, fGap });
+	timeline.push_back({ SIM_MODE_TELEOP, fTeleop });
+
+	if(fTest > 0.0)
+	{
+		timeline.push_back({ SIM_MODE_DISABLED, fGap });
+		timeline.push_back({ SIM_MODE_TEST, fTest });
+	}
+
+	timeline.push_back({ SIM_MODE_DISABLED, fGap });
+
+	// inputs read the way an idle robot reads them: pixies connected and
+	// centered, switches open (the roboRIO pulls its inputs up), sticks at rest
+
+	for(int i = 0; i < SIM_MAX_ANALOG; i++)
+	{
+		fAnalog[i] = SIM_PIXY_CENTERED;
+	}
+
+	for(int i = 0; i < SIM_MAX_DIGITAL; i++)
+	{
+		bDigital[i] = true;
+	}
+
+	for(int i = 0; i < SIM_MAX_JOYSTICKS; i++)
+	{
+		iPOV[i] = -1;
+	}
+
+	for(int i = 0; i < SIM_MAX_TALONS; i++)
+	{
+		SimTalon *pTalon = &talons[i];
+
+		memset(pTalon, 0, sizeof(SimTalon));
+		pTalon->iCanId = i;
+		pTalon->bEnabled = true;
+		pTalon->fFreeSpeed = 5000.0;
+		pTalon->iCountsPerRev = 4096;
+		pTalon->fStallCurrent = 40.0;
+		pTalon->fTimeConstant = 0.1;
+	}
+
+	for(const SimWiring &wiring : SIM_WIRING)
+	{
+		SimTalon *pTalon = &talons[wiring.iCanId];
+
+		pTalon->fFreeSpeed = wiring.fFreeSpeed;
+		pTalon->iCountsPerRev = wiring.iCountsPerRev;
+		pTalon->fStallCurrent = wiring.fStallCurrent;
+		pTalon->fTimeConstant = wiring.fTimeConstant;
+	}
+
+	std::thread(&SimWorld::ModelTask).detach();
+
+	RobotBase *pRobot = pCreateRobot();
+	pRobot->StartCompetition();		// WaitForPacket() ends the process when the match is over
+	return(0);
+}
+
+void SimWorld::Assert(bool bCondition, const char *szCondition, const char *szFile, int iLine)
+{
+	if(!bCondition)
+	{
+		printf("Assertion \"%s\" failed in %s line %d\n", szCondition, szFile, iLine);
+	}
+}
+
+void SimWorld::NameThread(pthread_t thread, const char *szName)
+{
+	char szShortName[16];
+
+	strncpy(szShortName, szName, sizeof(szShortName) - 1);
+	szShortName[sizeof(szShortName) - 1] = 0;
+	pthread_setname_np(thread, szShortName);
+}
+
+void SimWorld::ModelTask()
+{
+	PeriodicTimer timer(SIM_MODEL_PERIOD);
+
+	NameThread(pthread_self(), "tSimModel");
+	timer.Start();
+
+	while(true)
+	{
+		timer.WaitForNextTick();
+		Step(SIM_MODEL_PERIOD);
+	}
+}
+
+static void StepTalon(SimTalon *pTalon, double fOutput, double fSeconds)
+{
+	double fTarget;
+
+	fOutput = fmax(-1.0, fmin(1.0, fOutput));
+	fTarget = fOutput * pTalon->fFreeSpeed;
+
+	pTalon->fOutput = fOutput;
+	pTalon->fSpeed += (fTarget - pTalon->fSpeed) * fmin(1.0, fSeconds / pTalon->fTimeConstant);
+	pTalon->fPosition += pTalon->fSpeed / 60.0 * pTalon->iCountsPerRev * fSeconds;
+
+	if(fOutput == 0.0)
+	{
+		pTalon->fCurrent = 0.0;
+	}
+	else
+	{
+		pTalon->fCurrent = fabs(fOutput - pTalon->fSpeed / pTalon->fFreeSpeed) * pTalon->fStallCurrent;
+	}
+}
+
+void SimWorld::Step(double fSeconds)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+	bool bEnabled = IsEnabled();
+	double fTotalCurrent = 0.0;
+
+	// leaders first so their followers copy this step's output
+
+	for(int i = 0; i < SIM_MAX_TALONS; i++)
+	{
+		SimTalon *pTalon = &talons[i];
+		double fOutput = 0.0;
+
+		if(!pTalon->bPresent || (pTalon->iMode == CANSpeedController::kFollower))
+		{
+			continue;
+		}
+
+		if(bEnabled && pTalon->bEnabled)
+		{
+			if(pTalon->iMode == CANSpeedController::kSpeed)
+			{
+				fOutput = pTalon->fValue / pTalon->fFreeSpeed;
+			}
+			else
+			{
+				fOutput = pTalon->fValue;
+			}
+		}
+
+		StepTalon(pTalon, fOutput, fSeconds);
+		fTotalCurrent += pTalon->fCurrent;
+	}
+
+	for(int i = 0; i < SIM_MAX_TALONS; i++)
+	{
+		SimTalon *pTalon = &talons[i];
+		int iLeader = (int)pTalon->fValue;
+		double fOutput = 0.0;
+
+		if(!pTalon->bPresent || (pTalon->iMode != CANSpeedController::kFollower))
+		{
+			continue;
+		}
+
+		if(bEnabled && pTalon->bEnabled && (iLeader >= 0) && (iLeader < SIM_MAX_TALONS))
+		{
+			fOutput = talons[iLeader].fOutput;
+		}
+
+		StepTalon(pTalon, fOutput, fSeconds);
+		fTotalCurrent += pTalon->fCurrent;
+	}
+
+	// the drive encoders see the wheels, the gyro sees the difference between them
+
+	double fLeftFps = -talons[SIM_DRIVE_LEFT].fSpeed / 60.0 * REVSPERFOOT;
+	double fRightFps = talons[SIM_DRIVE_RIGHT].fSpeed / 60.0 * REVSPERFOOT;
+
+	fHeadingRate = (fLeftFps - fRightFps) / SIM_TRACK_WIDTH * 180.0 / M_PI;
+	fHeading += fHeadingRate * fSeconds;
+	fBattery = SIM_BATTERY_VOLTAGE - fTotalCurrent * SIM_BATTERY_RESISTANCE;
+}
+
+void SimWorld::WaitForPacket()
+{
+	double fElapsed;
+	double fPhaseStart = 0.0;
+	size_t uPhase;
+
+	if(fMatchStart < 0.0)
+	{
+		packetTimer.Start();
+		fMatchStart = RobotClock::Now();
+		realStart = std::chrono::steady_clock::now();
+	}
+
+	packetTimer.WaitForNextTick();
+	fElapsed = RobotClock::Now() - fMatchStart;
+
+	for(uPhase = 0; uPhase < timeline.size(); uPhase++)
+	{
+		if(fElapsed < fPhaseStart + timeline[uPhase].fDuration)
+		{
+			break;
+		}
+
+		fPhaseStart += timeline[uPhase].fDuration;
+	}
+
+	if(uPhase == timeline.size())
+	{
+		Finish();
+	}
+
+	fPhaseLeft = fPhaseStart + timeline[uPhase].fDuration - fElapsed;
+	iMode = timeline[uPhase].mode;
+}
+
+void SimWorld::Finish()
+{
+	{
+		std::lock_guard<std::mutex> sync(mutexWorld);
+
+		printf("sim: match over after %.1fs (%.2fs real), %u packets, %u late\n",
+				RobotClock::Now() - fMatchStart,
+				std::chrono::duration<double>(std::chrono::steady_clock::now() - realStart).count(),
+				packetTimer.GetTicks(), packetTimer.GetOverruns());
+		printf("sim: heading %.1f degrees, battery %.2fV\n", fHeading, fBattery);
+
+		for(int i = 0; i < SIM_MAX_TALONS; i++)
+		{
+			if(talons[i].bPresent)
+			{
+				printf("sim: talon %2d at %9.0f counts, %7.1f RPM, %5.1fA\n", i,
+						talons[i].fPosition, talons[i].fSpeed, talons[i].fCurrent);
+			}
+		}
+	}
+
+	if(bDumpDashboard)
+	{
+		DumpDashboard(stdout);
+	}
+
+	// the robot's tasks never return, so there is nothing to join
+
+	fflush(stdout);
+	fflush(stderr);
+	_exit(0);
+}
+
+SimMode SimWorld::GetMode()
+{
+	return((SimMode)iMode.load());
+}
+
+void SimWorld::SetMode(SimMode mode)
+{
+	iMode = mode;
+}
+
+bool SimWorld::IsEnabled()
+{
+	return(iMode != SIM_MODE_DISABLED);
+}
+
+double SimWorld::GetMatchTime()
+{
+	return(fPhaseLeft);
+}
+
+double SimWorld::GetBatteryVoltage()
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+	return(fBattery);
+}
+
+void SimWorld::SetJoystickAxis(int iStick, int iAxis, float fValue)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iStick >= 0) && (iStick < SIM_MAX_JOYSTICKS) && (iAxis >= 0) && (iAxis < SIM_MAX_AXES))
+	{
+		fAxes[iStick][iAxis] = fValue;
+	}
+}
+
+void SimWorld::SetJoystickButton(int iStick, int iButton, bool bPressed)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iStick >= 0) && (iStick < SIM_MAX_JOYSTICKS) && (iButton >= 1) && (iButton <= SIM_MAX_BUTTONS))
+	{
+		bButtons[iStick][iButton - 1] = bPressed;
+	}
+}
+
+void SimWorld::SetJoystickPOV(int iStick, int iAngle)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iStick >= 0) && (iStick < SIM_MAX_JOYSTICKS))
+	{
+		iPOV[iStick] = iAngle;
+	}
+}
+
+float SimWorld::GetJoystickAxis(int iStick, int iAxis)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iStick >= 0) && (iStick < SIM_MAX_JOYSTICKS) && (iAxis >= 0) && (iAxis < SIM_MAX_AXES))
+	{
+		return(fAxes[iStick][iAxis]);
+	}
+
+	return(0.0);
+}
+
+bool SimWorld::GetJoystickButton(int iStick, int iButton)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iStick >= 0) && (iStick < SIM_MAX_JOYSTICKS) && (iButton >= 1) && (iButton <= SIM_MAX_BUTTONS))
+	{
+		return(bButtons[iStick][iButton - 1]);
+	}
+
+	return(false);
+}
+
+int SimWorld::GetJoystickPOV(int iStick)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iStick >= 0) && (iStick < SIM_MAX_JOYSTICKS))
+	{
+		return(iPOV[iStick]);
+	}
+
+	return(-1);
+}
+
+std::mutex &SimWorld::GetMutex()
+{
+	return(mutexWorld);
+}
+
+SimTalon *SimWorld::GetTalon(int iCanId)
+{
+	if((iCanId < 0) || (iCanId >= SIM_MAX_TALONS))
+	{
+		printf("sim: no talon %d, using talon 0\n", iCanId);
+		iCanId = 0;
+	}
+
+	return(&talons[iCanId]);
+}
+
+void SimWorld::SetAnalog(int iChannel, float fVolts)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iChannel >= 0) && (iChannel < SIM_MAX_ANALOG))
+	{
+		fAnalog[iChannel] = fVolts;
+	}
+}
+
+float SimWorld::GetAnalog(int iChannel)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iChannel >= 0) && (iChannel < SIM_MAX_ANALOG))
+	{
+		return(fAnalog[iChannel]);
+	}
+
+	return(0.0);
+}
+
+void SimWorld::SetDigital(int iChannel, bool bValue)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iChannel >= 0) && (iChannel < SIM_MAX_DIGITAL))
+	{
+		bDigital[iChannel] = bValue;
+	}
+}
+
+bool SimWorld::GetDigital(int iChannel)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iChannel >= 0) && (iChannel < SIM_MAX_DIGITAL))
+	{
+		return(bDigital[iChannel]);
+	}
+
+	return(true);
+}
+
+void SimWorld::SetRelay(int iChannel, int iValue)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iChannel >= 0) && (iChannel < SIM_MAX_RELAYS))
+	{
+		iRelay[iChannel] = iValue;
+	}
+}
+
+int SimWorld::GetRelay(int iChannel)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iChannel >= 0) && (iChannel < SIM_MAX_RELAYS))
+	{
+		return(iRelay[iChannel]);
+	}
+
+	return(0);
+}
+
+void SimWorld::SetSolenoids(int iModule, uint8_t uValue, uint8_t uMask)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iModule >= 0) && (iModule <= SIM_MAX_PCMS))
+	{
+		uSolenoids[iModule] = (uSolenoids[iModule] & ~uMask) | (uValue & uMask);
+	}
+}
+
+uint8_t SimWorld::GetSolenoids(int iModule)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	if((iModule >= 0) && (iModule <= SIM_MAX_PCMS))
+	{
+		return(uSolenoids[iModule]);
+	}
+
+	return(0);
+}
+
+void SimWorld::GyroTransaction(int iPort, const uint8_t *pSend, uint8_t *pReceive, int iSize)
+{
+	memset(pReceive, 0, iSize);
+
+	if((iPort != SIM_GYRO_PORT) || (iSize < 3))
+	{
+		return;
+	}
+
+	// ADXRS453 rate reply: 16 bit two's complement, 80 LSB per degree per
+	// second, spread across the reply as  X X X X X X D D | D x 8 | D x 6 X X
+
+	int iRate;
+
+	{
+		std::lock_guard<std::mutex> sync(mutexWorld);
+		iRate = (int)lround(fHeadingRate * 80.0);
+	}
+
+	uint16_t uRate = (uint16_t)(int16_t)fmax(-32768.0, fmin(32767.0, iRate));
+
+	pReceive[0] = (uRate >> 14) & 0x03;
+	pReceive[1] = (uRate >> 6) & 0xFF;
+	pReceive[2] = (uRate << 2) & 0xFC;
+}
+
+double SimWorld::GetHeading()
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+	return(fHeading);
+}
+
+void SimWorld::PutValue(const std::string &key, const std::string &value)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+	dashboard[key] = value;
+}
+
+bool SimWorld::GetValue(const std::string &key, std::string &value)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+	std::map<std::string, std::string>::iterator it = dashboard.find(key);
+
+	if(it == dashboard.end())
+	{
+		return(false);
+	}
+
+	value = it->second;
+	return(true);
+}
+
+void SimWorld::DumpDashboard(FILE *pFile)
+{
+	std::lock_guard<std::mutex> sync(mutexWorld);
+
+	for(const std::pair<const std::string, std::string> &entry : dashboard)
+	{
+		fprintf(pFile, "%s = %s\n", entry.first.c_str(), entry.second.c_str());
+	}
+}
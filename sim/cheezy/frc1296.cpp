@@ -0,0 +1,63 @@
+/** \file
+ * Host stand-in for the cheezy drive library's C interface.
+ */
+
+#include <math.h>
+#include <stddef.h>
+
+#include "frc1296.h"
+
+const double CHEEZY_PERIOD = 0.005;			// seconds, how often CheezyLoop iterates
+const double CHEEZY_FULL_VOLTAGE = 12.0;
+
+static double fLastLeft;
+static double fLastRight;
+
+void CheezyInit1296()
+{
+	fLastLeft = 0.0;
+	fLastRight = 0.0;
+}
+
+void CheezyIterate1296(const DrivetrainGoal *pGoal, const DrivetrainPosition *pPosition,
+		DrivetrainOutput *pOutput, DrivetrainStatus *pStatus)
+{
+	double fAngular;
+	double fLeft;
+	double fRight;
+	double fScale;
+
+	if(pStatus != NULL)
+	{
+		pStatus->robot_speed = ((pPosition->left_encoder - fLastLeft)
+				+ (pPosition->right_encoder - fLastRight)) / 2.0 / CHEEZY_PERIOD;
+	}
+
+	fLastLeft = pPosition->left_encoder;
+	fLastRight = pPosition->right_encoder;
+
+	if(pOutput == NULL)
+	{
+		return;
+	}
+
+	// quick turn spins in place, otherwise the turn rate scales with the throttle
+
+	if(pGoal->quickturn)
+	{
+		fAngular = pGoal->steering;
+	}
+	else
+	{
+		fAngular = fabs(pGoal->throttle) * pGoal->steering;
+	}
+
+	fLeft = pGoal->throttle - fAngular;
+	fRight = pGoal->throttle + fAngular;
+	fScale = fmax(1.0, fmax(fabs(fLeft), fabs(fRight)));
+
+	pOutput->left_voltage = fLeft / fScale * CHEEZY_FULL_VOLTAGE;
+	pOutput->right_voltage = fRight / fScale * CHEEZY_FULL_VOLTAGE;
+	pOutput->left_high = pGoal->highgear;
+	pOutput->right_high = pGoal->highgear;
+}
@@ -0,0 +1,57 @@
+/** \file
+ * Host stand-in for the cheezy drive library's C interface.
+ *
+ * The real library is a separate checkout next to this one (Drivetrain.h
+ * includes it as ../cheezy/frc1296.h).  When building with -Isim/include that
+ * path lands here instead, so the simulator does not need the library.  If
+ * the library is checked out next to this tree its header is found first;
+ * link its sources instead of frc1296.cpp then.  The structures match the
+ * library's; the loop behind them is a plain cheesy drive mix, good enough to
+ * see the robot move the right way.
+ */
+
+#ifndef SIM_FRC1296_H
+#define SIM_FRC1296_H
+
+struct DrivetrainGoal
+{
+	double steering;			// positive turns left
+	double throttle;
+	bool quickturn;
+	bool control_loop_driving;
+	bool highgear;
+	double left_velocity_goal;
+	double right_velocity_goal;
+	double left_goal;
+	double right_goal;
+};
+
+struct DrivetrainPosition
+{
+	double left_encoder;		// meters
+	double right_encoder;
+	double gyro_angle;			// radians
+	double gyro_velocity;
+	double battery_voltage;
+	bool left_shifter_position;
+	bool right_shifter_position;
+};
+
+struct DrivetrainOutput
+{
+	double left_voltage;
+	double right_voltage;
+	bool left_high;
+	bool right_high;
+};
+
+struct DrivetrainStatus
+{
+	double robot_speed;			// meters per second
+};
+
+void CheezyInit1296();
+void CheezyIterate1296(const DrivetrainGoal *pGoal, const DrivetrainPosition *pPosition,
+		DrivetrainOutput *pOutput, DrivetrainStatus *pStatus);
+
+#endif //SIM_FRC1296_H
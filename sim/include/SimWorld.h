@@ -0,0 +1,140 @@
+/** \file
+ * In-memory models of the robot's hardware and the match it plays.
+ *
+ * A model task steps every SIM_MODEL_PERIOD: each talon's speed chases its
+ * command with a first order lag, its encoder integrates the speed and its
+ * current follows how hard it is pushing.  The drive talons move a robot whose
+ * turn rate is what the ADXRS453Z on SPI CS3 reports.  Analog inputs, digital
+ * inputs, joysticks and the dashboard are plain values that a bench or test
+ * harness can set and read back through the static calls below.
+ *
+ * The driver station half plays a match timeline, one 20ms packet at a time:
+ * disabled while the gyro calibrates, autonomous, disabled, teleop, optionally
+ * test, then disabled again before the process exits with a summary.  Every
+ * phase length can be changed on the command line, see Main(), and so can
+ * the RobotClock rate: -x 50 plays the match fifty times faster than real time.
+ * A harness that never plays a match can pick the mode itself with SetMode().
+ *
+ * Build the whole robot against it from the top of the tree; the files the
+ * robot reads and writes (RhsScript.txt, logs, traces) go in ROBOT_HOME_DIR:
+ * \verbatim
+   g++ -std=c++14 -O2 -Isim/include -I. -DROBOT_HOME_DIR='"sim_home/"' *.cpp sim/SimWorld.cpp sim/SimHal.cpp sim/cheezy/frc1296.cpp -o robotsim -lpthread
+   mkdir -p sim_home && cp RhsScript.txt sim_home/
+   ./robotsim -a 15 -t 10 -D
+   ./robotsim -p 16 -a 15 -t 0 -x 50
+   \endverbatim
+ * The scripts in tools/scripts exercise the autonomous commands, play any
+ * one of them as a short match and robotsim must exit cleanly:
+ * \verbatim
+   cp tools/scripts/StartDrive.txt sim_home/RhsScript.txt
+   ./robotsim -a 2 -g 0 -t 0 -x 10
+   \endverbatim
+ * Run it as root to get the SCHED_FIFO priorities ThreadConfig asks for.
+ */
+
+#ifndef SIM_WORLD_H
+#define SIM_WORLD_H
+
+#include <mutex>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+class RobotBase;
+
+typedef enum eSimMode
+{
+	SIM_MODE_DISABLED,
+	SIM_MODE_AUTONOMOUS,
+	SIM_MODE_TELEOP,
+	SIM_MODE_TEST
+} SimMode;
+
+const float SIM_MODEL_PERIOD = 0.005;		// seconds between model steps
+const float SIM_PACKET_PERIOD = 0.020;		// seconds between driver station packets
+const float SIM_BATTERY_VOLTAGE = 12.8;		// open circuit
+const float SIM_BATTERY_RESISTANCE = 0.015;	// ohms, sags the battery under load
+const int SIM_MAX_TALONS = 64;
+const int SIM_MAX_ANALOG = 8;
+const int SIM_MAX_DIGITAL = 26;
+const int SIM_MAX_RELAYS = 4;
+const int SIM_MAX_PCMS = 63;
+const int SIM_MAX_JOYSTICKS = 6;
+const int SIM_MAX_AXES = 12;
+const int SIM_MAX_BUTTONS = 32;
+
+/** One CAN talon: the command it was given and what its motor did with it. */
+struct SimTalon
+{
+	int iCanId;
+	int iMode;						// CANSpeedController::ControlMode
+	float fValue;					// last Set(), meaning depends on iMode
+	bool bEnabled;
+	bool bInverted;
+	bool bPresent;					// someone constructed a CANTalon for it
+
+	float fFreeSpeed;				// RPM at full output
+	int iCountsPerRev;				// encoder counts per motor revolution
+	float fStallCurrent;			// amps at full output, not moving
+	float fTimeConstant;			// seconds for the speed to get 63% of the way
+
+	double fPosition;				// encoder counts
+	int iPositionOffset;			// subtracted by SetEncPosition, not by the pulse width position
+	double fSpeed;					// RPM
+	double fOutput;					// -1..1 actually applied
+	double fCurrent;				// amps
+};
+
+class SimWorld
+{
+public:
+	static int Main(int argc, char **argv, RobotBase *(*pCreateRobot)());
+	static void Assert(bool bCondition, const char *szCondition, const char *szFile, int iLine);
+	static void NameThread(pthread_t thread, const char *szName);
+
+	static void Step(double fSeconds);
+
+	// driver station
+
+	static void WaitForPacket();
+	static SimMode GetMode();
+	static void SetMode(SimMode mode);		// for harnesses with no match, the next packet undoes it
+	static bool IsEnabled();
+	static double GetMatchTime();
+	static double GetBatteryVoltage();
+
+	static void SetJoystickAxis(int iStick, int iAxis, float fValue);
+	static void SetJoystickButton(int iStick, int iButton, bool bPressed);
+	static void SetJoystickPOV(int iStick, int iAngle);
+	static float GetJoystickAxis(int iStick, int iAxis);
+	static bool GetJoystickButton(int iStick, int iButton);
+	static int GetJoystickPOV(int iStick);
+
+	// devices, hold GetMutex() while reading or writing a SimTalon
+
+	static std::mutex &GetMutex();
+	static SimTalon *GetTalon(int iCanId);
+	static void SetAnalog(int iChannel, float fVolts);
+	static float GetAnalog(int iChannel);
+	static void SetDigital(int iChannel, bool bValue);
+	static bool GetDigital(int iChannel);
+	static void SetRelay(int iChannel, int iValue);
+	static int GetRelay(int iChannel);
+	static void SetSolenoids(int iModule, uint8_t uValue, uint8_t uMask);
+	static uint8_t GetSolenoids(int iModule);
+	static void GyroTransaction(int iPort, const uint8_t *pSend, uint8_t *pReceive, int iSize);
+	static double GetHeading();		// degrees, clockwise positive
+
+	// dashboard
+
+	static void PutValue(const std::string &key, const std::string &value);
+	static bool GetValue(const std::string &key, std::string &value);
+	static void DumpDashboard(FILE *pFile);
+
+private:
+	static void ModelTask();
+	static void Finish();
+};
+
+#endif //SIM_WORLD_H
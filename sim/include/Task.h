@@ -0,0 +1,32 @@
+/** \file
+ * Host stand-in for WPILib's Task, a named std::thread.
+ */
+
+#ifndef SIM_TASK_H
+#define SIM_TASK_H
+
+#include <string>
+#include <thread>
+#include <utility>
+
+//Robot
+#include "SimWorld.h"		//For naming the thread
+
+class Task
+{
+public:
+	template<class Function, class... Args>
+	Task(const std::string &name, Function &&function, Args&&... args)
+	: thread(std::forward<Function>(function), std::forward<Args>(args)...)
+	{
+		SimWorld::NameThread(thread.native_handle(), name.c_str());
+	};
+	~Task();
+
+	bool Verify() { return(true); };
+
+private:
+	std::thread thread;
+};
+
+#endif //SIM_TASK_H
@@ -0,0 +1,351 @@
+/** \file
+ * Host stand-in for the parts of WPILib this robot uses.
+ *
+ * Same class names and signatures as the roboRIO library, so the robot
+ * sources build unchanged when sim/include comes first on the include path.
+ * Nothing here talks to hardware: every device reads and writes the in-memory
+ * models in SimWorld, and the driver station is a scripted match timeline.
+ * Only the calls the robot actually makes are here; add more as they are used.
+ */
+
+#ifndef SIM_WPILIB_H
+#define SIM_WPILIB_H
+
+#include <atomic>
+#include <math.h>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <utility>
+
+//Robot
+#include "SimWorld.h"		//For the device models behind every class below
+#include "Task.h"
+
+typedef std::mutex priority_mutex;
+typedef std::recursive_mutex priority_recursive_mutex;
+typedef void (*FUNCPTR)(...);
+
+#define wpi_assert(condition) SimWorld::Assert((condition), #condition, __FILE__, __LINE__)
+
+void Wait(double fSeconds);
+
+class Timer
+{
+public:
+	Timer();
+
+	void Start();
+	void Stop();
+	void Reset();
+	double Get() const;
+
+	static double GetFPGATimestamp();
+
+private:
+	mutable std::mutex mutexTimer;
+	double fStartTime;
+	double fAccumulated;
+	bool bRunning;
+};
+
+class PIDSource
+{
+public:
+	virtual ~PIDSource() {};
+	virtual double PIDGet() = 0;
+};
+
+class PIDOutput
+{
+public:
+	virtual ~PIDOutput() {};
+	virtual void PIDWrite(float output) = 0;
+};
+
+class CANSpeedController
+{
+public:
+	enum ControlMode { kPercentVbus = 0, kCurrent = 1, kSpeed = 2, kPosition = 3, kVoltage = 4, kFollower = 5 };
+	enum NeutralMode { kNeutralMode_Jumper = 0, kNeutralMode_Brake = 1, kNeutralMode_Coast = 2 };
+};
+
+class CANTalon : public CANSpeedController, public PIDOutput, public PIDSource
+{
+public:
+	enum FeedbackDevice { QuadEncoder = 0, AnalogPot = 2, AnalogEncoder = 3, EncRising = 4, EncFalling = 5,
+		CtreMagEncoder_Relative = 6, CtreMagEncoder_Absolute = 7, PulseWidth = 8 };
+
+	explicit CANTalon(int iDeviceNumber);
+	virtual ~CANTalon();
+
+	void Set(float fValue);
+	float Get();
+	void SetControlMode(ControlMode mode);
+	void ConfigNeutralMode(NeutralMode mode);
+	void SetFeedbackDevice(FeedbackDevice device);
+	void ConfigEncoderCodesPerRev(uint16_t uCodesPerRev);
+	void SelectProfileSlot(int iSlot);
+	void SetPID(double fP, double fI, double fD, double fF);
+	void SetIzone(unsigned uIzone);
+	void SetCloseLoopRampRate(double fRampRate);
+	void SetInverted(bool bInverted);
+	bool IsAlive();
+	int GetEncPosition();
+	void SetEncPosition(int iPosition);
+	int GetPulseWidthPosition();
+	double GetSpeed();
+	double GetOutputCurrent();
+	void Enable();
+	void Disable();
+
+	virtual void PIDWrite(float fOutput);
+	virtual double PIDGet();
+
+private:
+	SimTalon *pModel;
+};
+
+class SPI
+{
+public:
+	enum Port { kOnboardCS0 = 0, kOnboardCS1, kOnboardCS2, kOnboardCS3, kMXP };
+
+	explicit SPI(Port port);
+	virtual ~SPI();
+
+	void SetClockRate(double fHz);
+	void SetMSBFirst();
+	void SetLSBFirst();
+	void SetSampleDataOnFalling();
+	void SetSampleDataOnRising();
+	void SetClockActiveLow();
+	void SetClockActiveHigh();
+	void SetChipSelectActiveHigh();
+	void SetChipSelectActiveLow();
+
+	int Write(uint8_t *pData, uint8_t uSize);
+	int Read(bool bInitiate, uint8_t *pData, uint8_t uSize);
+	int Transaction(uint8_t *pDataToSend, uint8_t *pDataReceived, uint8_t uSize);
+
+	void InitAccumulator(double fPeriod, uint32_t uCmd, uint8_t uXferSize, uint32_t uValidMask,
+			uint32_t uValidValue, uint8_t uDataShift, uint8_t uDataSize, bool bIsSigned, bool bBigEndian);
+	void FreeAccumulator();
+	void ResetAccumulator();
+	void SetAccumulatorCenter(int32_t iCenter);
+	int32_t GetAccumulatorLastValue() const;
+	int64_t GetAccumulatorValue() const;
+	uint32_t GetAccumulatorCount() const;
+	double GetAccumulatorAverage() const;
+
+private:
+	Port port;
+};
+
+class AnalogInput
+{
+public:
+	explicit AnalogInput(uint32_t uChannel);
+
+	float GetVoltage() const;
+	float GetAverageVoltage() const;
+
+private:
+	uint32_t uChannel;
+};
+
+class DigitalInput
+{
+public:
+	explicit DigitalInput(uint32_t uChannel);
+
+	bool Get() const;
+
+private:
+	uint32_t uChannel;
+};
+
+class Relay
+{
+public:
+	enum Value { kOff, kOn, kForward, kReverse };
+	enum Direction { kBothDirections, kForwardOnly, kReverseOnly };
+
+	Relay(uint32_t uChannel, Direction direction = kBothDirections);
+
+	void Set(Value value);
+	Value Get() const;
+
+private:
+	uint32_t uChannel;
+};
+
+class SolenoidBase
+{
+public:
+	explicit SolenoidBase(uint8_t uModuleNumber);
+	virtual ~SolenoidBase() {};
+
+	void Set(uint8_t uValue, uint8_t uMask, int iModule);
+	uint8_t GetAll(int iModule = 0) const;
+
+protected:
+	uint8_t uModuleNumber;
+};
+
+class Solenoid : public SolenoidBase
+{
+public:
+	Solenoid(uint8_t uModuleNumber, uint32_t uChannel);
+
+	void Set(bool bOn);
+	bool Get() const;
+
+private:
+	uint32_t uChannel;
+};
+
+class PIDController
+{
+public:
+	PIDController(float fP, float fI, float fD, PIDSource *pSource, PIDOutput *pOutput, float fPeriod = 0.05);
+	virtual ~PIDController();
+
+	void SetSetpoint(float fSetpoint);
+	double GetSetpoint() const;
+	void SetOutputRange(float fMinimum, float fMaximum);
+	void SetTolerance(float fPercent);
+	float GetError() const;
+	float GetAvgError() const;
+	void Enable();
+	void Disable();
+	bool IsEnabled() const;
+
+private:
+	void Calculate();
+	static void Run(PIDController *pThis);
+
+	mutable std::recursive_mutex mutexPID;
+	PIDSource *pSource;
+	PIDOutput *pOutput;
+	float fP, fI, fD;
+	float fPeriod;
+	float fMinimumOutput;
+	float fMaximumOutput;
+	float fSetpoint;
+	float fError;
+	float fPrevError;
+	float fAvgError;
+	float fTotalError;
+	bool bEnabled;
+	std::atomic<bool> bStop;
+	std::thread thread;
+};
+
+class Joystick
+{
+public:
+	explicit Joystick(uint32_t uPort);
+
+	float GetRawAxis(uint32_t uAxis) const;
+	bool GetRawButton(uint32_t uButton) const;
+	int GetPOV(uint32_t uPov = 0) const;
+
+private:
+	uint32_t uPort;
+};
+
+class DriverStation
+{
+public:
+	static DriverStation &GetInstance();
+	static void ReportError(std::string error);
+
+	void WaitForData();
+	float GetBatteryVoltage() const;
+	double GetMatchTime() const;
+
+	bool IsDisabled() const;
+	bool IsEnabled() const;
+	bool IsAutonomous() const;
+	bool IsOperatorControl() const;
+	bool IsTest() const;
+};
+
+class SmartDashboard
+{
+public:
+	static void init();
+
+	static void PutNumber(const std::string &key, double fValue);
+	static void PutString(const std::string &key, const std::string &value);
+	static void PutBoolean(const std::string &key, bool bValue);
+	static double GetNumber(const std::string &key, double fDefault);
+	static std::string GetString(const std::string &key, const std::string &defaultValue);
+	static bool GetBoolean(const std::string &key, bool bDefault);
+};
+
+class NetworkTable
+{
+public:
+	static std::shared_ptr<NetworkTable> GetTable(const std::string &key);
+
+	std::shared_ptr<NetworkTable> GetSubTable(const std::string &key);
+	void PutBoolean(const std::string &key, bool bValue);
+
+private:
+	std::string path;
+};
+
+class LiveWindow
+{
+public:
+	static LiveWindow *GetInstance();
+
+	void SetEnabled(bool bEnabled);
+	bool IsEnabled() const { return(bEnabled); };
+
+private:
+	bool bEnabled = false;
+};
+
+class RobotBase
+{
+public:
+	static RobotBase &getInstance();
+
+	bool IsEnabled() const;
+	bool IsDisabled() const;
+	bool IsAutonomous() const;
+	bool IsOperatorControl() const;
+	bool IsTest() const;
+
+	virtual void StartCompetition() = 0;
+
+protected:
+	RobotBase();
+	virtual ~RobotBase();
+
+	DriverStation &m_ds;
+
+private:
+	static RobotBase *pInstance;
+};
+
+namespace HALUsageReporting
+{
+	enum tResourceType { kResourceType_Framework = 22 };
+	enum tInstances { kFramework_Iterative = 1, kFramework_Sample = 2, kFramework_CommandControl = 3 };
+}
+
+void HALReport(uint8_t uResource, uint8_t uInstanceNumber, uint8_t uContext = 0, const char *szFeature = NULL);
+void HALNetworkCommunicationObserveUserProgramStarting();
+
+#define START_ROBOT_CLASS(_ClassName_) \
+	static RobotBase *SimCreateRobot() { return(new _ClassName_()); } \
+	int main(int argc, char **argv) { return(SimWorld::Main(argc, argv, &SimCreateRobot)); }
+
+#endif //SIM_WPILIB_H
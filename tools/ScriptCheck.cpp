@@ -0,0 +1,115 @@
+/** \file
+ * Checks autonomous scripts on any computer, before they go near the robot.
+ *
+ * Every script is compiled and checked by the same code the robot runs when
+ * it loads RhsScript.txt (AutoCompileText() and AutoValidate() in
+ * AutoParser.cpp).  Unknown commands, missing or malformed numbers, values
+ * out of range and PARALLEL blocks that do not close are reported as errors
+ * with their line numbers.  After each script comes the longest it can take,
+ * every command waiting out its timeout, against the autonomous period.
+ * \verbatim
+   g++ -std=c++11 -O2 -I. tools/ScriptCheck.cpp AutoParser.cpp -o scriptcheck
+   ./scriptcheck RhsScript.txt
+   cd tools/scripts && ../../scriptcheck *.txt
+   \endverbatim
+ * Every script in tools/scripts must come out clean.
+ * Options:
+ *  -s			strict, a worst case longer than AUTONOMOUS_PERIOD is an error too
+ *  -q			only the summary line of each script
+ *
+ * Exits with 0 when every script is clean, 1 if any has errors and 2 if one
+ * could not be read.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+//Robot
+#include <AutoParser.h>
+#include <RobotParams.h>
+
+static bool bStrict = false;
+static bool bQuiet = false;
+
+///0 if the script is clean, 1 if it has errors, 2 if it could not be read
+static int CheckScript(const char *szFile)
+{
+	std::ifstream scriptStream(szFile, std::ios::in | std::ios::binary);
+	std::vector<char> text;
+	std::vector<AutoInstruction> program;
+	AutoCheck check;
+	int iLength;
+
+	if(!scriptStream.is_open())
+	{
+		fprintf(stderr, "scriptcheck: cannot read %s\n", szFile);
+		return(2);
+	}
+
+	text.assign(std::istreambuf_iterator<char>(scriptStream), std::istreambuf_iterator<char>());
+	text.push_back('\0');
+
+	// an instruction for every line, the way the robot lays out its arena
+
+	program.resize(std::count(text.begin(), text.end(), '\n') + 1);
+	iLength = AutoCompileText(text.data(), program.data());
+
+	check = AutoValidate(program.data(), iLength, szFile, bQuiet ? NULL : stdout);
+
+	if(bQuiet)
+	{
+		printf("%s: %d error%s, %d warning%s, worst case %0.1fs of %gs\n", szFile,
+				check.iErrors, (check.iErrors == 1) ? "" : "s", check.iWarnings, (check.iWarnings == 1) ? "" : "s",
+				check.fWorstCase, AUTONOMOUS_PERIOD);
+	}
+
+	if(check.iErrors || (bStrict && (check.fWorstCase > AUTONOMOUS_PERIOD)))
+	{
+		return(1);
+	}
+
+	return(0);
+}
+
+int main(int argc, char **argv)
+{
+	int iOption;
+	int iResult = 0;
+	int iScript;
+
+	while((iOption = getopt(argc, argv, "sq")) != -1)
+	{
+		switch(iOption)
+		{
+		case 's':
+			bStrict = true;
+			break;
+
+		case 'q':
+			bQuiet = true;
+			break;
+
+		default:
+			fprintf(stderr, "usage: %s [-s] [-q] [script ...]\n", argv[0]);
+			return(2);
+		}
+	}
+
+	if(optind == argc)
+	{
+		return(CheckScript("RhsScript.txt"));
+	}
+
+	for(int i = optind; i < argc; ++i)
+	{
+		iScript = CheckScript(argv[i]);
+		iResult = (iScript > iResult) ? iScript : iResult;
+	}
+
+	return(iResult);
+}